@@ -0,0 +1,63 @@
+#ifndef __HostArduino_h__
+#define __HostArduino_h__
+
+// Host build: the parts of the Arduino core the display driver and Adafruit_GFX use, on top of the
+// simulated ESP32 in SimHost.cpp
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <algorithm>
+
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+using std::max;
+using std::min;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define PROGMEM
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int level);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+class String : public std::string
+{
+public:
+    String() {}
+    String(const char *s) : std::string(s ? s : "") {}
+    String(const std::string &s) : std::string(s) {}
+    String(char c) : std::string(1, c) {}
+    String(int v) : std::string(std::to_string(v)) {}
+    String(unsigned v) : std::string(std::to_string(v)) {}
+    String(long v) : std::string(std::to_string(v)) {}
+    String(unsigned long v) : std::string(std::to_string(v)) {}
+
+    unsigned int length() const { return size(); }
+    bool isEmpty() const { return empty(); }
+    char charAt(unsigned int i) const { return i < size() ? (*this)[i] : 0; }
+    String substring(unsigned int from) const { return from < size() ? substr(from) : std::string(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        return from < size() && from < to ? substr(from, to - from) : std::string();
+    }
+    int indexOf(char c, unsigned int from = 0) const
+    {
+        size_t p = find(c, from);
+        return p == npos ? -1 : (int)p;
+    }
+    long toInt() const { return atol(c_str()); }
+};
+
+#endif // __HostArduino_h__
@@ -0,0 +1,302 @@
+#include "GoldenImages.h"
+
+#include <Arduino.h>
+
+#include "Adafruit_GFX.h"
+#include "Benchmark.h"
+#include "Font5x7Fixed.h"
+#include "Font5x7FixedMono.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+struct GoldenCase
+{
+    const char *name;
+    const GFXfont *font;    // nullptr for the classic font
+    String text;
+    int width, height;      // canvas
+    int x, y;               // where the text starts; custom fonts are drawn from the baseline
+    int size = 1;
+    bool wrap = false;
+    bool opaque = false;    // classic font on a lit canvas, with the background drawn
+};
+
+// characters from first to last
+static String charRange(int first, int last)
+{
+    String s;
+    for (int c = first; c <= last; c++)
+    {
+        s += (char)c;
+    }
+    return s;
+}
+
+static int goldenCases(GoldenCase *cases)
+{
+    String printable = charRange(' ', '~');
+    String clipped = "Clipped at both edges";
+    int n = 0;
+
+    // every glyph of each font
+    cases[n++] = {"glyphs-5x7", &Font5x7Fixed, printable, getTextWidth(&Font5x7Fixed, printable), 7, 0, 7};
+    cases[n++] = {"glyphs-5x7mono", &Font5x7FixedMono, printable, getTextWidth(&Font5x7FixedMono, printable), 7, 0, 7};
+    cases[n++] = {"glyphs-classic", nullptr, printable, (int)printable.length() * 6, 8, 0, 0};
+    cases[n++] = {"glyphs-classic-high", nullptr, charRange(0x80, 0xFF), 128 * 6, 8, 0, 0};
+
+    // a long message, the whole of it
+    String text = benchMessage(512);
+    cases[n++] = {"long-5x7", &Font5x7Fixed, text, getTextWidth(&Font5x7Fixed, text), 7, 0, 7};
+
+    // clipped at the edges of a one module canvas: left and right, then top and bottom
+    cases[n++] = {"clip-5x7", &Font5x7Fixed, clipped, 60, 7, -3, 7};
+    cases[n++] = {"clip-top-5x7", &Font5x7Fixed, clipped, 60, 7, -3, 4};
+    cases[n++] = {"clip-bottom-5x7", &Font5x7Fixed, clipped, 60, 7, -3, 10};
+    cases[n++] = {"clip-classic", nullptr, clipped, 60, 8, -4, -3};
+
+    // scaled, and clipped through the middle of a scaled row; wrapped and opaque
+    cases[n] = {"scaled-5x7", &Font5x7Fixed, "Big 2x", 80, 14, 1, 14};
+    cases[n++].size = 2;
+    cases[n] = {"clip-scaled-5x7", &Font5x7Fixed, "Clipped 2x", 60, 10, -5, 11};
+    cases[n++].size = 2;
+    cases[n] = {"wrap-5x7", &Font5x7Fixed, "Wraps onto the next line", 60, 16, 0, 7};
+    cases[n++].wrap = true;
+    cases[n] = {"wrap-classic", nullptr, "Wraps onto the next line", 60, 32, 0, 0};
+    cases[n++].wrap = true;
+    cases[n] = {"opaque-classic", nullptr, "Opaque bg", 60, 8, 2, 0};
+    cases[n++].opaque = true;
+    return n;
+}
+
+// draw a case the way the display code does, through write()
+static void render(const GoldenCase &c, Adafruit_GFX &canvas)
+{
+    canvas.fillScreen(c.opaque ? 1 : 0);
+    canvas.setFont(c.font);
+    canvas.setTextSize(c.size);
+    canvas.setTextWrap(c.wrap);
+    if (c.opaque)
+    {
+        canvas.setTextColor(0, 1);
+    }
+    else
+    {
+        canvas.setTextColor(1);
+    }
+    canvas.setCursor(c.x, c.y);
+    for (int i = 0; i < (int)c.text.length(); i++)
+    {
+        canvas.write(c.text[i]);
+    }
+}
+
+// a PBM (P4) image holds the same MSb-first rows, padded to whole bytes, as a GFXcanvas1
+static std::string toPbm(const GFXcanvas1 &canvas, int width, int height)
+{
+    std::string pbm = "P4\n" + std::to_string(width) + " " + std::to_string(height) + "\n";
+    pbm.append((const char *)canvas.getBuffer(), (width + 7) / 8 * height);
+    return pbm;
+}
+
+// the same from a column canvas, a group of 8 columns at a time
+static std::string toPbm(const GFXcanvasColumns &canvas, int width, int height)
+{
+    int rowBytes = (width + 7) / 8;
+    std::string rows(rowBytes * height, 0);
+    for (int g = 0; g < rowBytes; g++)
+    {
+        uint8_t columns[8] = {}, bytes[8];
+        memcpy(columns, &canvas.getBuffer()[g * 8], min(8, width - g * 8));
+        GFXcanvasColumns::transpose8(columns, bytes);
+        for (int y = 0; y < height; y++)
+        {
+            rows[y * rowBytes + g] = bytes[y];
+        }
+    }
+    return "P4\n" + std::to_string(width) + " " + std::to_string(height) + "\n" + rows;
+}
+
+static bool readPbm(const std::string &path, std::string &pbm)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    pbm = content.str();
+    return true;
+}
+
+// compare against the golden image; reports and returns false on a difference
+static bool compare(const GoldenCase &c, const char *canvas, const std::string &pbm, const std::string &golden)
+{
+    std::string header = "P4\n" + std::to_string(c.width) + " " + std::to_string(c.height) + "\n";
+    if (golden.compare(0, header.size(), header) != 0 || golden.size() != pbm.size())
+    {
+        printf("FAIL %s%s: golden image isn't %dx%d\n", c.name, canvas, c.width, c.height);
+        return false;
+    }
+
+    int rowBytes = (c.width + 7) / 8;
+    int differ = 0, firstX = 0, firstY = 0;
+    for (int y = 0; y < c.height; y++)
+    {
+        for (int x = 0; x < c.width; x++)
+        {
+            size_t i = header.size() + y * rowBytes + x / 8;
+            if (((pbm[i] ^ golden[i]) >> (7 - x % 8)) & 1)
+            {
+                if (!differ++)
+                {
+                    firstX = x;
+                    firstY = y;
+                }
+            }
+        }
+    }
+    if (differ)
+    {
+        printf("FAIL %s%s: %d pixels differ, the first at (%d, %d)\n", c.name, canvas, differ, firstX, firstY);
+        return false;
+    }
+    return true;
+}
+
+// a 1-bit canvas that draws bitmaps a pixel at a time, as the reference for its blits
+class PixelCanvas : public GFXcanvas1
+{
+public:
+    using GFXcanvas1::GFXcanvas1;
+    bool blitBitmap(int16_t, int16_t, const uint8_t *, uint32_t, uint16_t, int16_t, int16_t, uint16_t,
+                    uint16_t) override
+    {
+        return false;
+    }
+};
+
+// drawBitmap() through the blits of GFXcanvas1 and GFXcanvasColumns, at every bit offset and clipped
+// at each edge, in each colour combination, has to match drawing it a pixel at a time; returns false
+// on a difference
+static bool checkBlits()
+{
+    static const uint8_t bitmap[] = {0xA5, 0x3C, 0xF0, 0x0F, 0x81, 0x7E, 0x55, 0xAA, 0xC3,
+                                     0x18, 0xE7, 0x24, 0x99, 0x66, 0xFF, 0x01, 0x80, 0x5A};
+    static const uint16_t colors[][2] = {{1, 1}, {0, 0}, {1, 0}, {0, 1}};   // the same is transparent
+    int w = 21, h = 6;  // rows of 3 bytes, the last partly padding
+    for (int x = -10; x < 40; x++)
+    {
+        for (int y = -3; y < 8; y++)
+        {
+            for (const uint16_t *c : colors)
+            {
+                GFXcanvas1 canvas(36, 7);
+                PixelCanvas pixels(36, 7);
+                GFXcanvasColumns columns(36, 7);
+                for (Adafruit_GFX *target : {(Adafruit_GFX *)&canvas, (Adafruit_GFX *)&pixels, (Adafruit_GFX *)&columns})
+                {
+                    target->fillScreen(0);
+                    target->fillRect(4, 1, 20, 4, 1);   // something to draw over
+                    if (c[0] == c[1])
+                    {
+                        target->drawBitmap(x, y, bitmap, w, h, c[0]);   // transparent
+                    }
+                    else
+                    {
+                        target->drawBitmap(x, y, bitmap, w, h, c[0], c[1]);
+                    }
+                }
+                if (memcmp(canvas.getBuffer(), pixels.getBuffer(), (36 + 7) / 8 * 7) != 0)
+                {
+                    printf("FAIL blit: drawBitmap(%d, %d) in %u on %u differs from drawing it a pixel at a time\n",
+                           x, y, c[0], c[1]);
+                    return false;
+                }
+                for (int i = 0; i < 36 * 7; i++)
+                {
+                    if (columns.getPixel(i % 36, i / 36) != pixels.getPixel(i % 36, i / 36))
+                    {
+                        printf("FAIL blit: drawBitmap(%d, %d) in %u on %u into columns differs at (%d, %d)\n",
+                               x, y, c[0], c[1], i % 36, i / 36);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int checkGoldenImages(const char *dir, bool update)
+{
+    static GoldenCase cases[16];
+    int count = goldenCases(cases);
+    int failed = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const GoldenCase &c = cases[i];
+        GFXcanvas1 canvas(c.width, c.height);
+        render(c, canvas);
+        std::string pbm = toPbm(canvas, c.width, c.height);
+        std::string path = std::string(dir) + "/" + c.name + ".pbm";
+
+        bool ok = true;
+        if (update)
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << pbm;
+            ok = (bool)file;
+            if (!ok)
+            {
+                printf("FAIL %s: can't write %s\n", c.name, path.c_str());
+            }
+        }
+        else
+        {
+            std::string golden;
+            if (!readPbm(path, golden))
+            {
+                printf("FAIL %s: no golden image %s\n", c.name, path.c_str());
+                ok = false;
+            }
+            else
+            {
+                ok = compare(c, "", pbm, golden);
+
+                // a column canvas has to draw exactly the same
+                if (c.height <= 8)
+                {
+                    GFXcanvasColumns columns(c.width, c.height);
+                    render(c, columns);
+                    ok &= compare(c, " (columns)", toPbm(columns, c.width, c.height), golden);
+                }
+            }
+        }
+
+        // the display lays text out by getTextWidth(), so it has to agree with what write() draws
+        if (c.font && c.size == 1 && !c.wrap)
+        {
+            int drawn = canvas.getCursorX() - c.x;
+            int measured = getTextWidth(c.font, c.text);
+            if (drawn != measured)
+            {
+                printf("FAIL %s: getTextWidth() is %d, write() advanced %d\n", c.name, measured, drawn);
+                ok = false;
+            }
+        }
+        failed += !ok;
+    }
+
+    if (!checkBlits())
+    {
+        failed++;
+    }
+
+    printf("golden images: %d cases, %d failed%s\n", count, failed, update ? " (updated)" : "");
+    return failed;
+}
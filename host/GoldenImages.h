@@ -0,0 +1,13 @@
+#ifndef __GoldenImages_h__
+#define __GoldenImages_h__
+
+// Golden images of text rendering: representative text (every glyph of each font, long messages,
+// clipping at the canvas edges, scaling, opaque backgrounds) drawn into GFXcanvas1 through write()
+// and drawChar(), and compared pixel for pixel against PBM images in dir; text up to 8 rows high is
+// also drawn into GFXcanvasColumns, which has to match the same images. Also checks getTextWidth()
+// against how far write() moved the cursor, and GFXcanvas1's bitmap blits against drawing a pixel at a
+// time. With update, the images are written instead.
+// Returns the number of cases that failed
+int checkGoldenImages(const char *dir, bool update);
+
+#endif // __GoldenImages_h__
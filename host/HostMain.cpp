@@ -0,0 +1,178 @@
+// Host build entry point: runs the display driver on the simulated ESP32.
+//   program ["text" [seconds]]         print what the panel showed
+//   program --scan [options] [seconds] scan timing report: per row duty cycle, refresh rate, row
+//                                      brightness imbalance and worst case idle time
+//   program --bench [--baseline file]  micro-benchmarks of the render kernels, as JSON lines (build with
+//                                      -D BENCHMARK=1); exits with status 1 on regressions against
+//                                      the baseline, an earlier report
+//   program --golden [dir] [--update]  compare text rendering against the golden images in dir
+//                                      (host/golden); exits with status 1 on a difference. --update
+//                                      rewrites them, after a deliberate change to the rendering
+// options:
+//   --brightness N         0..255
+//   --modules N, --register-bits N     panel geometry
+//   --read-cost N          simulated µs per timer read
+//   --check                exit with status 1 if the scan misses the limits in ScanReport.h; the
+//                          native tests (pio test -e native) run this for the build configuration
+//                          they're built with
+
+#include "ScrollingDisplay.h"
+#include "Benchmark.h"
+#include "GoldenImages.h"
+#include "ScanReport.h"
+#include "SimHost.h"
+#include "SimPanel.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#define ROWS 7
+#define GOLDEN_DIR "host/golden"
+
+struct Options
+{
+    const char *text = "Hello from the host";
+    double seconds = 2;
+    bool scan = false;
+    bool check = false;
+    bool bench = false;
+    const char *baseline = nullptr;     // file
+    const char *golden = nullptr;       // directory
+    bool update = false;
+    int brightness = 255;
+    ScrollingDisplayIntf::Geometry geometry;
+};
+
+void printPanel()
+{
+    simPanel.print(stdout, ROWS, ScrollingDisplay.getColumns());
+
+    ScrollingDisplayIntf::Stats stats = ScrollingDisplay.getStats();
+    ScrollingDisplayIntf::Metrics metrics;
+    ScrollingDisplay.getMetrics(metrics);
+    printf("\n%llu us simulated: %u frames (%u late), %u rendered, %u latches, %u latched with LEDs on\n",
+           (unsigned long long)simTime(), metrics.frames, metrics.framesLate, metrics.framesRendered,
+           simPanel.latches, simPanel.badLatches);
+    printf("row shift %u us (max %u), wake latency avg %u us (max %u)\n", stats.spiTransferUs,
+           stats.spiTransferMaxUs, stats.wakeLatencyAvgUs, stats.wakeLatencyMaxUs);
+    for (int r = 0; r < ROWS; r++)
+    {
+        printf("row %d: %llu us on in %u pulses\n", r, (unsigned long long)simPanel.onUs[r], simPanel.pulses[r]);
+    }
+}
+
+// runs the benchmarks, in real time rather than simulated; returns false on regressions
+bool benchmark(const Options &options)
+{
+#if BENCHMARK
+    std::string baseline;
+    if (options.baseline)
+    {
+        std::ifstream file(options.baseline);
+        if (!file)
+        {
+            fprintf(stderr, "can't read %s\n", options.baseline);
+            return false;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+        baseline = content.str();
+    }
+    int regressions = runBenchmarks([](const char *line)
+                                    { puts(line); }, options.baseline ? baseline.c_str() : nullptr);
+    return regressions == 0;
+#else
+    fprintf(stderr, "build with -D BENCHMARK=1 for --bench\n");
+    return false;
+#endif
+}
+
+#ifndef PIO_UNIT_TESTING    // the test runner's suites (test/) have their own
+int main(int argc, char **argv)
+{
+    Options options;
+    int positional = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--scan"))
+        {
+            options.scan = true;
+        }
+        else if (!strcmp(arg, "--check"))
+        {
+            options.check = true;
+        }
+        else if (!strcmp(arg, "--bench"))
+        {
+            options.bench = true;
+        }
+        else if (!strcmp(arg, "--golden"))
+        {
+            options.golden = hasValue && argv[i + 1][0] != '-' ? argv[++i] : GOLDEN_DIR;
+        }
+        else if (!strcmp(arg, "--update"))
+        {
+            options.update = true;
+        }
+        else if (!strcmp(arg, "--baseline") && hasValue)
+        {
+            options.baseline = argv[++i];
+        }
+        else if (!strcmp(arg, "--brightness") && hasValue)
+        {
+            options.brightness = atoi(argv[++i]);
+        }
+        else if (!strcmp(arg, "--modules") && hasValue)
+        {
+            options.geometry.modules = atoi(argv[++i]);
+        }
+        else if (!strcmp(arg, "--register-bits") && hasValue)
+        {
+            options.geometry.registerBits = atoi(argv[++i]);
+        }
+        else if (!strcmp(arg, "--read-cost") && hasValue)
+        {
+            simReadCostUs = atoi(argv[++i]);
+        }
+        else if (!options.scan && positional == 0)
+        {
+            options.text = arg;
+            positional++;
+        }
+        else
+        {
+            options.seconds = atof(arg);
+        }
+    }
+
+    if (options.golden)
+    {
+        return checkGoldenImages(options.golden, options.update) ? 1 : 0;
+    }
+
+    ScrollingDisplay.setGeometry(options.geometry);
+    if (options.bench)
+    {
+        return benchmark(options) ? 0 : 1;
+    }
+    ScrollingDisplay.begin();
+    ScrollingDisplay.setBrightness(options.brightness);
+
+    if (options.scan)
+    {
+        simRun(SCAN_WARMUP_US);
+        return scanReport(options.seconds, options.brightness, options.check) ? 0 : 1;
+    }
+
+    simRun(SCAN_WARMUP_US);
+    ScrollingDisplay.setText(options.text);    // once the render task has taken the default text
+    simRun(options.seconds * 1000000);
+    printPanel();
+    return 0;
+}
+#endif // PIO_UNIT_TESTING
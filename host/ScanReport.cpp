@@ -0,0 +1,98 @@
+#include "ScanReport.h"
+
+#include "ScrollingDisplay.h"
+#include "SimHost.h"
+#include "SimPanel.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#define ROWS 7
+
+// longest stretch with no row lit
+static uint64_t lastOff = 0;
+static uint64_t worstIdleUs = 0;
+
+bool scanReport(double seconds, int brightness, bool check)
+{
+    lastOff = 0;
+    worstIdleUs = 0;
+    ScrollingDisplayIntf::Metrics before, after;
+    ScrollingDisplay.getMetrics(before);
+    simPanel.reset();
+    simPanel.onPulse = [](int row, uint64_t on, uint64_t off)
+    {
+        if (lastOff && on > lastOff)
+        {
+            worstIdleUs = std::max(worstIdleUs, on - lastOff);
+        }
+        lastOff = off;
+    };
+
+    uint64_t us = seconds * 1000000;
+    simRun(us);
+    ScrollingDisplay.getMetrics(after);
+
+    uint32_t frames = after.frames - before.frames;
+    uint32_t late = after.framesLate - before.framesLate;
+    uint32_t periods = after.framePeriod.count - before.framePeriod.count;
+    uint64_t periodUs = after.framePeriod.sum - before.framePeriod.sum;
+    double refreshHz = periodUs ? periods * 1e6 / periodUs : 0;
+
+    uint64_t minOn = UINT64_MAX, maxOn = 0, totalOn = 0;
+    for (int r = 0; r < ROWS; r++)
+    {
+        minOn = std::min(minOn, simPanel.onUs[r]);
+        maxOn = std::max(maxOn, simPanel.onUs[r]);
+        totalOn += simPanel.onUs[r];
+    }
+    double meanOn = (double)totalOn / ROWS;
+    double imbalance = meanOn > 0 ? (maxOn - minOn) / meanOn : 0;
+
+    printf("scan report: %.3f s simulated, brightness %d, %d columns, %u us per timer read\n", seconds,
+           brightness, ScrollingDisplay.getColumns(), simReadCostUs);
+    printf("  refresh      %.2f Hz (%u frames, %u late)\n", refreshHz, frames, late);
+    printf("  row  duty     on us    pulses/s\n");
+    for (int r = 0; r < ROWS; r++)
+    {
+        printf("  %d    %5.2f%%   %-8llu %.1f\n", r, simPanel.onUs[r] * 100.0 / us,
+               (unsigned long long)simPanel.onUs[r], simPanel.pulses[r] * 1e6 / us);
+    }
+    printf("  imbalance    %.2f%% (max - min row on time, over the mean)\n", imbalance * 100);
+    printf("  dark         %.2f%% of the time no row is lit; worst idle %llu us\n",
+           100 - totalOn * 100.0 / us, (unsigned long long)worstIdleUs);
+    printf("  ghosting     %u latches or row changes with the LEDs on\n", simPanel.badLatches);
+
+    if (!check)
+    {
+        return true;
+    }
+
+    bool ok = true;
+    if (refreshHz < MIN_REFRESH_HZ)
+    {
+        printf("FAIL: refresh below %.1f Hz\n", MIN_REFRESH_HZ);
+        ok = false;
+    }
+    if (late)
+    {
+        printf("FAIL: late frames\n");
+        ok = false;
+    }
+    if (minOn < MIN_DUTY * brightness / 255 * us)
+    {
+        printf("FAIL: row duty below %.2f%%\n", MIN_DUTY * brightness / 255 * 100);
+        ok = false;
+    }
+    if (imbalance > MAX_IMBALANCE)
+    {
+        printf("FAIL: row imbalance over %.1f%%\n", MAX_IMBALANCE * 100);
+        ok = false;
+    }
+    if (simPanel.badLatches)
+    {
+        printf("FAIL: latched or changed rows with the LEDs on\n");
+        ok = false;
+    }
+    return ok;
+}
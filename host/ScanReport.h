@@ -0,0 +1,17 @@
+#ifndef __ScanReport_h__
+#define __ScanReport_h__
+
+#define SCAN_WARMUP_US 100000   // startup and the first frame, to run before the report
+
+// check limits
+#define MIN_REFRESH_HZ 59.0
+#define MAX_IMBALANCE 0.02      // of the mean row on time
+#define MIN_DUTY 0.06           // each row's on time at full brightness, scaled down with brightness
+
+// Runs the display for seconds of simulated time and reports on the scan: per row duty cycle, refresh
+// rate, row brightness imbalance and worst case idle time. brightness is only for the report; set it
+// on the display first. With check, the limits above, no late frames and no latching with the LEDs
+// on are checked too, and each one missed is reported. Returns false if check is set and any is missed
+bool scanReport(double seconds, int brightness, bool check);
+
+#endif // __ScanReport_h__
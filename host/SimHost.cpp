@@ -0,0 +1,507 @@
+#include "SimHost.h"
+#include "SimPanel.h"
+
+#include "Arduino.h"
+#include "driver/timer.h"
+#include "driver/spi_master.h"
+#include "hal/spi_ll.h"
+#include "hal/gpio_ll.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+uint32_t simReadCostUs = 1;
+gpio_dev_t GPIO;
+
+struct SimTask
+{
+    TaskFunction_t fn;
+    void *param;
+    UBaseType_t priority;
+    uint32_t notifications = 0;
+    std::function<bool()> waitFor;  // blocked until this is true
+    uint64_t wakeAt = UINT64_MAX;   // or until this time
+};
+
+struct spi_device_t
+{
+    int clockHz;
+    int csPin;      // -1 if CS is left to the caller
+    transaction_cb_t postCb;
+};
+
+struct spi_dev_t
+{
+    uint8_t buffer[SimPanel::MaxRowBytes];
+    int bits;
+    bool busy;
+};
+
+namespace
+{
+// never destroyed, as the task threads are still waiting on them at exit
+std::mutex &cpuLock = *new std::mutex;
+std::condition_variable &cpuHandoff = *new std::condition_variable;
+
+SimTask *running = nullptr;     // task holding the CPU; nullptr while simRun() has it
+std::vector<SimTask *> tasks;
+uint64_t simNow = 0;
+uint64_t runUntil = 0;
+bool inTimerIsr = false;
+
+// timer
+uint64_t timerOffset = 0;       // counter = simNow - timerOffset
+bool timerStarted = false;
+bool alarmEnabled = false;
+uint64_t alarmValue = 0;
+timer_isr_t timerIsr = nullptr;
+void *timerIsrArg = nullptr;
+
+// SPI: the driver's transactions, and the peripheral driven directly by the ISR scan
+struct SpiTransfer
+{
+    spi_transaction_t *trans;   // nullptr for a transfer started with spi_ll_user_start()
+    const uint8_t *data;
+    int bits;
+    uint64_t doneAt;
+};
+spi_device_t spiDevice = {1000000, -1, nullptr};
+spi_dev_t spiHw = {};
+std::deque<SpiTransfer> spiTransfers;   // first one is shifting out
+std::deque<spi_transaction_t *> spiResults;
+
+uint64_t spiDuration(int bits)
+{
+    return ((uint64_t)bits * 1000000 + spiDevice.clockHz - 1) / spiDevice.clockHz;
+}
+
+void spiStart(spi_transaction_t *trans, const uint8_t *data, int bits)
+{
+    uint64_t start = spiTransfers.empty() ? simNow : spiTransfers.back().doneAt;
+    if (spiTransfers.empty() && spiDevice.csPin >= 0)
+    {
+        simPanel.setPin(spiDevice.csPin, LOW, simNow);
+    }
+    spiTransfers.push_back({trans, data, bits, start + spiDuration(bits)});
+}
+
+void spiComplete()
+{
+    SpiTransfer done = spiTransfers.front();
+    spiTransfers.pop_front();
+
+    simPanel.shiftIn(done.data, done.bits);
+    if (spiDevice.csPin >= 0)
+    {
+        simPanel.setPin(spiDevice.csPin, HIGH, done.doneAt);    // CS rising edge latches the row
+        if (!spiTransfers.empty())
+        {
+            simPanel.setPin(spiDevice.csPin, LOW, done.doneAt);
+        }
+    }
+
+    if (done.trans)
+    {
+        if (spiDevice.postCb)
+        {
+            spiDevice.postCb(done.trans);
+        }
+        spiResults.push_back(done.trans);
+    }
+    else
+    {
+        spiHw.busy = false;
+    }
+}
+
+// runs whatever interrupts (and SPI completions) are due by now
+void runEvents()
+{
+    for (;;)
+    {
+        if (!spiTransfers.empty() && spiTransfers.front().doneAt <= simNow)
+        {
+            spiComplete();
+        }
+        else if (!inTimerIsr && timerStarted && alarmEnabled && alarmValue + timerOffset <= simNow)
+        {
+            // one-shot; like the IDF's default handler, re-armed if the callback moved the alarm
+            alarmEnabled = false;
+            uint64_t alarm = alarmValue;
+            inTimerIsr = true;
+            if (timerIsr)
+            {
+                timerIsr(timerIsrArg);
+            }
+            inTimerIsr = false;
+            alarmEnabled = alarmValue != alarm;
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+// when the next interrupt, SPI completion or task timeout is due
+uint64_t nextEvent()
+{
+    uint64_t next = UINT64_MAX;
+    if (!spiTransfers.empty())
+    {
+        next = spiTransfers.front().doneAt;
+    }
+    if (timerStarted && alarmEnabled)
+    {
+        next = min(next, max(alarmValue + timerOffset, simNow));
+    }
+    for (SimTask *t : tasks)
+    {
+        next = min(next, t->wakeAt);
+    }
+    return next;
+}
+
+// give up the CPU until 'until' is true (or wakeAt); tasks only
+void park(SimTask *self, std::function<bool()> until, uint64_t wakeAt = UINT64_MAX)
+{
+    std::unique_lock<std::mutex> lock(cpuLock);
+    self->waitFor = std::move(until);
+    self->wakeAt = wakeAt;
+    running = nullptr;
+    cpuHandoff.notify_all();
+    cpuHandoff.wait(lock, [self]
+                    { return running == self; });
+    self->waitFor = nullptr;
+    self->wakeAt = UINT64_MAX;
+}
+
+// time spent by the running code; tasks give up the CPU at the end of a run
+void advance(uint64_t us)
+{
+    simNow += us;
+    runEvents();
+    if (running && !inTimerIsr && simNow >= runUntil)
+    {
+        park(running, []
+             { return true; });
+    }
+}
+
+void taskMain(SimTask *task)
+{
+    {
+        std::unique_lock<std::mutex> lock(cpuLock);
+        cpuHandoff.wait(lock, [task]
+                        { return running == task; });
+    }
+    task->fn(task->param);
+
+    // FreeRTOS tasks mustn't return; if one does, it just never runs again
+    park(task, []
+         { return false; });
+}
+} // namespace
+
+uint64_t simTime()
+{
+    return simNow;
+}
+
+void simRun(uint64_t us)
+{
+    std::unique_lock<std::mutex> lock(cpuLock);
+    runUntil = simNow + us;
+
+    while (simNow < runUntil)
+    {
+        // the highest priority task that can run gets the CPU until it blocks
+        SimTask *next = nullptr;
+        for (SimTask *t : tasks)
+        {
+            bool ready = !t->waitFor || t->waitFor() || simNow >= t->wakeAt;
+            if (ready && (!next || t->priority > next->priority))
+            {
+                next = t;
+            }
+        }
+        if (next)
+        {
+            running = next;
+            cpuHandoff.notify_all();
+            cpuHandoff.wait(lock, []
+                            { return running == nullptr; });
+            continue;
+        }
+
+        // nothing can run; move on to the next event
+        simNow = min(max(nextEvent(), simNow), runUntil);
+        runEvents();
+    }
+}
+
+// Arduino
+
+void pinMode(int pin, int mode)
+{
+}
+
+void digitalWrite(int pin, int level)
+{
+    simPanel.setPin(pin, level, simNow);
+}
+
+void gpio_ll_set_level(gpio_dev_t *hw, gpio_num_t pin, uint32_t level)
+{
+    simPanel.setPin(pin, level, simNow);
+}
+
+unsigned long millis()
+{
+    return simNow / 1000;
+}
+
+unsigned long micros()
+{
+    return simNow;
+}
+
+void delay(unsigned long ms)
+{
+    vTaskDelay(ms);
+}
+
+int64_t esp_timer_get_time()
+{
+    return simNow;
+}
+
+// FreeRTOS
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param, UBaseType_t priority,
+                       TaskHandle_t *handle)
+{
+    SimTask *task = new SimTask{fn, param, priority};
+    tasks.push_back(task);
+    std::thread(taskMain, task).detach();
+    if (handle)
+    {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    uint64_t wakeAt = simNow + ticks * 1000ULL;
+    if (running)
+    {
+        park(running, []
+             { return false; }, wakeAt);
+    }
+    else
+    {
+        simRun(wakeAt - simNow);
+    }
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return simNow / 1000;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    task->notifications++;
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken)
+{
+    task->notifications++;
+    if (higherPriorityTaskWoken && running && task->priority > running->priority)
+    {
+        *higherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait)
+{
+    SimTask *self = running;
+    if (!self)
+    {
+        return 0;
+    }
+
+    if (!self->notifications && ticksToWait)
+    {
+        uint64_t wakeAt = ticksToWait == portMAX_DELAY ? UINT64_MAX : simNow + ticksToWait * 1000ULL;
+        park(self, [self]
+             { return self->notifications > 0; }, wakeAt);
+    }
+
+    uint32_t count = self->notifications;
+    if (count)
+    {
+        self->notifications = clearOnExit ? 0 : count - 1;
+    }
+    return count;
+}
+
+// timer
+
+esp_err_t timer_init(timer_group_t group, timer_idx_t idx, const timer_config_t *config)
+{
+    alarmEnabled = config->alarm_en == TIMER_ALARM_EN;
+    timerStarted = config->counter_en == TIMER_START;
+    return ESP_OK;
+}
+
+esp_err_t timer_set_counter_value(timer_group_t group, timer_idx_t idx, uint64_t value)
+{
+    timerOffset = simNow - value;
+    return ESP_OK;
+}
+
+esp_err_t timer_get_counter_value(timer_group_t group, timer_idx_t idx, uint64_t *value)
+{
+    advance(simReadCostUs);
+    *value = simNow - timerOffset;
+    return ESP_OK;
+}
+
+esp_err_t timer_set_alarm_value(timer_group_t group, timer_idx_t idx, uint64_t value)
+{
+    alarmValue = value;
+    return ESP_OK;
+}
+
+esp_err_t timer_set_alarm(timer_group_t group, timer_idx_t idx, int alarmEn)
+{
+    alarmEnabled = alarmEn == TIMER_ALARM_EN;
+    return ESP_OK;
+}
+
+esp_err_t timer_enable_intr(timer_group_t group, timer_idx_t idx)
+{
+    return ESP_OK;
+}
+
+esp_err_t timer_isr_callback_add(timer_group_t group, timer_idx_t idx, timer_isr_t isr, void *arg, int flags)
+{
+    timerIsr = isr;
+    timerIsrArg = arg;
+    return ESP_OK;
+}
+
+esp_err_t timer_start(timer_group_t group, timer_idx_t idx)
+{
+    timerStarted = true;
+    return ESP_OK;
+}
+
+uint64_t timer_group_get_counter_value_in_isr(timer_group_t group, timer_idx_t idx)
+{
+    advance(simReadCostUs);
+    return simNow - timerOffset;
+}
+
+void timer_group_set_alarm_value_in_isr(timer_group_t group, timer_idx_t idx, uint64_t value)
+{
+    alarmValue = value;
+}
+
+// SPI master driver
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *config, int dmaChan)
+{
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *config,
+                             spi_device_handle_t *handle)
+{
+    spiDevice = {config->clock_speed_hz, config->spics_io_num, config->post_cb};
+    *handle = &spiDevice;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans, uint32_t ticksToWait)
+{
+    spiStart(trans, (const uint8_t *)trans->tx_buffer, trans->length);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans, uint32_t ticksToWait)
+{
+    if (spiResults.empty() && running && ticksToWait)
+    {
+        park(running, []
+             { return !spiResults.empty(); });
+    }
+    if (spiResults.empty())
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    *trans = spiResults.front();
+    spiResults.pop_front();
+    return ESP_OK;
+}
+
+// only used at startup, so it takes no time
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans)
+{
+    if (spiDevice.csPin >= 0)
+    {
+        simPanel.setPin(spiDevice.csPin, LOW, simNow);
+    }
+    simPanel.shiftIn((const uint8_t *)trans->tx_buffer, trans->length);
+    if (spiDevice.csPin >= 0)
+    {
+        simPanel.setPin(spiDevice.csPin, HIGH, simNow);
+    }
+    return ESP_OK;
+}
+
+esp_err_t spi_device_acquire_bus(spi_device_handle_t handle, uint32_t wait)
+{
+    return ESP_OK;
+}
+
+// SPI peripheral, for the ISR scan
+
+spi_dev_t *simSpiHw()
+{
+    return &spiHw;
+}
+
+void spi_ll_clear_int_stat(spi_dev_t *hw)
+{
+}
+
+void spi_ll_write_buffer(spi_dev_t *hw, const uint8_t *buffer, size_t bitlen)
+{
+    hw->bits = min<size_t>(bitlen, sizeof(hw->buffer) * 8);
+    memcpy(hw->buffer, buffer, (hw->bits + 7) / 8);
+}
+
+void spi_ll_apply_config(spi_dev_t *hw)
+{
+}
+
+void spi_ll_user_start(spi_dev_t *hw)
+{
+    hw->busy = true;
+    spiStart(nullptr, hw->buffer, hw->bits);
+}
+
+bool spi_ll_usr_is_done(spi_dev_t *hw)
+{
+    return !hw->busy;
+}
@@ -0,0 +1,20 @@
+#ifndef __SimHost_h__
+#define __SimHost_h__
+
+#include <cstdint>
+
+// Simulated ESP32 for host builds. There's one simulated CPU: FreeRTOS tasks are threads, but only
+// the one holding the CPU runs, until it blocks. Time only moves when nothing can run (to the next
+// timer alarm or SPI completion), or when a task reads the timer, which costs simReadCostUs; so a
+// busy-wait takes simulated time, while the code between blocking calls takes none. Timer and SPI
+// interrupts run at their due time on whichever thread is moving time on.
+
+extern uint32_t simReadCostUs;  // simulated cost of reading the timer, 1 µs by default
+
+uint64_t simTime();             // µs since start
+
+// Runs the tasks for the given simulated time, returning with them all blocked. Call from main()
+// only; anything else main() does (setText() etc.) happens between runs, in no simulated time
+void simRun(uint64_t us);
+
+#endif // __SimHost_h__
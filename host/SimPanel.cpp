@@ -0,0 +1,86 @@
+#include "SimPanel.h"
+#include "ScrollingDisplay.h"
+
+#include <cstring>
+
+SimPanel simPanel;
+
+// bits come out MSb first; the chain only holds the last MaxRowBytes worth
+void SimPanel::shiftIn(const uint8_t *data, int bits)
+{
+    int bytes = (bits + 7) / 8;
+    if (bytes > MaxRowBytes)
+    {
+        data += bytes - MaxRowBytes;
+        bytes = MaxRowBytes;
+    }
+    memcpy(shifter, data, bytes);
+}
+
+void SimPanel::setPin(int pin, int level, uint64_t t)
+{
+    using PinDefs = ScrollingDisplayIntf::PinDefs;
+
+    if (pin == PinDefs::cs)
+    {
+        if (level && !cs)
+        {
+            memcpy(latch, shifter, sizeof(latch));
+            latches++;
+            if (lit)
+            {
+                badLatches++;
+            }
+        }
+        cs = level;
+    }
+    else if (pin == PinDefs::r0 || pin == PinDefs::r1 || pin == PinDefs::r2)
+    {
+        int bit = pin == PinDefs::r0 ? 1 : pin == PinDefs::r1 ? 2 : 4;
+        int next = level ? row | bit : row & ~bit;
+        if (next != row && lit)
+        {
+            badLatches++;
+        }
+        row = next;
+    }
+    else if (pin == PinDefs::oe)
+    {
+        bool on = !level;   // active low
+        if (on && !lit)
+        {
+            litSince = t;
+            memcpy(shown[row], latch, sizeof(latch));
+        }
+        else if (!on && lit)
+        {
+            onUs[row] += t - litSince;
+            pulses[row]++;
+            if (onPulse)
+            {
+                onPulse(row, litSince, t);
+            }
+        }
+        lit = on;
+    }
+}
+
+void SimPanel::reset()
+{
+    memset(onUs, 0, sizeof(onUs));
+    memset(pulses, 0, sizeof(pulses));
+    latches = 0;
+    badLatches = 0;
+}
+
+void SimPanel::print(FILE *out, int rows, int bits) const
+{
+    for (int r = 0; r < rows; r++)
+    {
+        for (int b = 0; b < bits && b < MaxRowBytes * 8; b++)
+        {
+            fputc(shown[r][b / 8] & (0x80 >> (b % 8)) ? '#' : '.', out);
+        }
+        fputc('\n', out);
+    }
+}
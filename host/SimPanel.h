@@ -0,0 +1,43 @@
+#ifndef __SimPanel_h__
+#define __SimPanel_h__
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+// The display boards as seen from the ESP32's pins: a shift register chain clocked from SPI, latched
+// on the rising edge of CS, and lit onto the selected row while OE is low
+class SimPanel
+{
+public:
+    static constexpr int MaxRowBytes = 64;
+    static constexpr int RowSelects = 8;    // 3 row select lines
+
+    void shiftIn(const uint8_t *data, int bits);
+    void setPin(int pin, int level, uint64_t t);
+
+    // what's been shown: the latch contents the last time each row was lit, and the LED on time
+    // and OE pulses per row since reset()
+    uint8_t shown[RowSelects][MaxRowBytes] = {};
+    uint64_t onUs[RowSelects] = {};
+    uint32_t pulses[RowSelects] = {};
+    uint32_t latches = 0;
+    uint32_t badLatches = 0;    // latched or row changed with the LEDs on, which shows as ghosting
+
+    std::function<void(int row, uint64_t on, uint64_t off)> onPulse;   // called at the end of each OE pulse
+
+    void reset();
+    void print(FILE *out, int rows, int bits) const;    // shown rows as text, '#' for a lit LED
+
+private:
+    uint8_t shifter[MaxRowBytes] = {};
+    uint8_t latch[MaxRowBytes] = {};
+    int row = 0;
+    int cs = 1;
+    bool lit = false;
+    uint64_t litSince = 0;
+};
+
+extern SimPanel simPanel;
+
+#endif // __SimPanel_h__
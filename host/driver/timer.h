@@ -0,0 +1,72 @@
+#ifndef __HostTimer_h__
+#define __HostTimer_h__
+
+// Legacy general purpose timer driver (IDF 4.4), one simulated timer. The counter runs at 1 MHz
+// whatever the divider, which is what the display uses
+
+#include <cstdint>
+
+typedef int esp_err_t;
+
+typedef enum
+{
+    TIMER_GROUP_0,
+    TIMER_GROUP_1,
+} timer_group_t;
+typedef enum
+{
+    TIMER_0,
+    TIMER_1,
+} timer_idx_t;
+
+enum
+{
+    TIMER_ALARM_DIS = 0,
+    TIMER_ALARM_EN = 1,
+};
+enum
+{
+    TIMER_PAUSE = 0,
+    TIMER_START = 1,
+};
+enum
+{
+    TIMER_INTR_LEVEL = 0,
+};
+enum
+{
+    TIMER_COUNT_DOWN = 0,
+    TIMER_COUNT_UP = 1,
+};
+enum
+{
+    TIMER_AUTORELOAD_DIS = 0,
+    TIMER_AUTORELOAD_EN = 1,
+};
+
+typedef struct
+{
+    int alarm_en;
+    int counter_en;
+    int intr_type;
+    int counter_dir;
+    int auto_reload;
+    uint32_t divider;
+} timer_config_t;
+
+typedef bool (*timer_isr_t)(void *arg);
+
+esp_err_t timer_init(timer_group_t group, timer_idx_t idx, const timer_config_t *config);
+esp_err_t timer_set_counter_value(timer_group_t group, timer_idx_t idx, uint64_t value);
+esp_err_t timer_get_counter_value(timer_group_t group, timer_idx_t idx, uint64_t *value);
+esp_err_t timer_set_alarm_value(timer_group_t group, timer_idx_t idx, uint64_t value);
+esp_err_t timer_set_alarm(timer_group_t group, timer_idx_t idx, int alarmEn);
+esp_err_t timer_enable_intr(timer_group_t group, timer_idx_t idx);
+esp_err_t timer_isr_callback_add(timer_group_t group, timer_idx_t idx, timer_isr_t isr, void *arg, int flags);
+esp_err_t timer_start(timer_group_t group, timer_idx_t idx);
+
+// from the timer ISR
+uint64_t timer_group_get_counter_value_in_isr(timer_group_t group, timer_idx_t idx);
+void timer_group_set_alarm_value_in_isr(timer_group_t group, timer_idx_t idx, uint64_t value);
+
+#endif // __HostTimer_h__
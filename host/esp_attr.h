@@ -0,0 +1,9 @@
+#ifndef __HostEspAttr_h__
+#define __HostEspAttr_h__
+
+// memory placement doesn't matter on the host
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define DMA_ATTR
+
+#endif // __HostEspAttr_h__
@@ -0,0 +1,8 @@
+#ifndef __HostEspTimer_h__
+#define __HostEspTimer_h__
+
+#include <cstdint>
+
+int64_t esp_timer_get_time();   // simulated time, µs
+
+#endif // __HostEspTimer_h__
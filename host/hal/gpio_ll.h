@@ -0,0 +1,16 @@
+#ifndef __HostGpioLl_h__
+#define __HostGpioLl_h__
+
+#include <cstdint>
+
+typedef struct gpio_dev_t
+{
+    int unused;
+} gpio_dev_t;
+extern gpio_dev_t GPIO;
+
+typedef int gpio_num_t;
+
+void gpio_ll_set_level(gpio_dev_t *hw, gpio_num_t pin, uint32_t level);
+
+#endif // __HostGpioLl_h__
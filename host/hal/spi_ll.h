@@ -0,0 +1,19 @@
+#ifndef __HostSpiLl_h__
+#define __HostSpiLl_h__
+
+// SPI low level calls used by the ISR scan, on the simulated peripheral
+
+#include <cstdint>
+#include <cstddef>
+
+typedef struct spi_dev_t spi_dev_t;
+spi_dev_t *simSpiHw();
+#define SPI_LL_GET_HW(host) simSpiHw()
+
+void spi_ll_clear_int_stat(spi_dev_t *hw);
+void spi_ll_write_buffer(spi_dev_t *hw, const uint8_t *buffer, size_t bitlen);
+void spi_ll_apply_config(spi_dev_t *hw);
+void spi_ll_user_start(spi_dev_t *hw);
+bool spi_ll_usr_is_done(spi_dev_t *hw);
+
+#endif // __HostSpiLl_h__
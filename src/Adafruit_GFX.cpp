@@ -87,6 +87,14 @@ inline uint8_t *pgm_read_bitmap_ptr(const GFXfont *gfxFont) {
 #define min(a, b) (((a) < (b)) ? (a) : (b))
 #endif
 
+// Whether -resident bitmaps can be handed to blitBitmap() to read in place;
+// not where they're in a separate address space, or need aligned reads
+#if defined(__AVR__) || defined(ESP8266)
+#define BLIT_PROGMEM 0
+#else
+#define BLIT_PROGMEM 1
+#endif
+
 #ifndef _swap_int16_t
 #define _swap_int16_t(a, b)                                                    \
   {                                                                            \
@@ -527,6 +535,29 @@ void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h,
   endWrite();
 }
 
+/**************************************************************************/
+/*!
+   @brief   Draw rows of packed 1-bit source, MSb first, in one go. The base
+   class can't, and returns false for the caller to draw a pixel at a time
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  Source bytes
+    @param    bit     Bit of the source the top left pixel is at
+    @param    stride  Bits from one row of the source to the next
+    @param    w   Width in pixels
+    @param    h   Height in pixels
+    @param    color 16-bit 5-6-5 Color to draw set bits with
+    @param    bg 16-bit 5-6-5 Color to draw clear bits with; if the same as
+   color, they're transparent
+    @returns  true if drawn
+*/
+/**************************************************************************/
+bool Adafruit_GFX::blitBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
+                              uint32_t bit, uint16_t stride, int16_t w,
+                              int16_t h, uint16_t color, uint16_t bg) {
+  return false;
+}
+
 /**************************************************************************/
 /*!
    @brief   Draw a rounded rectangle with no fill color
@@ -717,6 +748,11 @@ void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
   int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
   uint8_t b = 0;
 
+#if BLIT_PROGMEM
+  if (blitBitmap(x, y, bitmap, 0, byteWidth * 8, w, h, color, color))
+    return;
+#endif
+
   startWrite();
   for (int16_t j = 0; j < h; j++, y++) {
     for (int16_t i = 0; i < w; i++) {
@@ -752,6 +788,12 @@ void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
   int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
   uint8_t b = 0;
 
+#if BLIT_PROGMEM
+  if (bg != color &&
+      blitBitmap(x, y, bitmap, 0, byteWidth * 8, w, h, color, bg))
+    return;
+#endif
+
   startWrite();
   for (int16_t j = 0; j < h; j++, y++) {
     for (int16_t i = 0; i < w; i++) {
@@ -783,6 +825,9 @@ void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w,
   int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
   uint8_t b = 0;
 
+  if (blitBitmap(x, y, bitmap, 0, byteWidth * 8, w, h, color, color))
+    return;
+
   startWrite();
   for (int16_t j = 0; j < h; j++, y++) {
     for (int16_t i = 0; i < w; i++) {
@@ -817,6 +862,10 @@ void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w,
   int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
   uint8_t b = 0;
 
+  if (bg != color &&
+      blitBitmap(x, y, bitmap, 0, byteWidth * 8, w, h, color, bg))
+    return;
+
   startWrite();
   for (int16_t j = 0; j < h; j++, y++) {
     for (int16_t i = 0; i < w; i++) {
@@ -1183,15 +1232,22 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
     uint8_t w = pgm_read_byte(&glyph->width), h = pgm_read_byte(&glyph->height);
     int8_t xo = pgm_read_byte(&glyph->xOffset),
            yo = pgm_read_byte(&glyph->yOffset);
-    uint8_t xx, yy, bits = 0, bit = 0;
-    int16_t xo16 = 0, yo16 = 0;
-
-    if (size_x > 1 || size_y > 1) {
-      xo16 = xo;
-      yo16 = yo;
-    }
+    uint8_t xx, yy, bits;
 
-    // Todo: Add character clipping here
+    // Clip: a glyph wholly off the canvas costs nothing, and of the rest
+    // only the rows and columns on it, x0 to x1 and y0 to y1, are visited
+    int16_t left = x + xo * size_x, top = y + yo * size_y;
+    if (!w || !h || left >= _width || top >= _height ||
+        left + w * size_x <= 0 || top + h * size_y <= 0)
+      return;
+    uint8_t x0 = left < 0 ? -left / size_x : 0;
+    uint8_t y0 = top < 0 ? -top / size_y : 0;
+    uint8_t x1 = left + w * size_x > _width
+                     ? (_width - left + size_x - 1) / size_x
+                     : w;
+    uint8_t y1 = top + h * size_y > _height
+                     ? (_height - top + size_y - 1) / size_y
+                     : h;
 
     // NOTE: THERE IS NO 'BACKGROUND' COLOR OPTION ON CUSTOM FONTS.
     // THIS IS ON PURPOSE AND BY DESIGN.  The background color feature
@@ -1209,21 +1265,29 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
     // displays supporting setAddrWindow() and pushColors()), but haven't
     // implemented this yet.
 
+#if BLIT_PROGMEM
+    // glyph rows are packed with no padding, so a row is w bits on
+    if (size_x == 1 && size_y == 1 &&
+        blitBitmap(left, top, bitmap, bo * 8, w, w, h, color, color))
+      return;
+#endif
+
     startWrite();
-    for (yy = 0; yy < h; yy++) {
-      for (xx = 0; xx < w; xx++) {
-        if (!(bit++ & 7)) {
-          bits = pgm_read_byte(&bitmap[bo++]);
-        }
+    for (yy = y0; yy < y1; yy++) {
+      uint16_t bit = yy * w + x0; // of the first pixel visited in the row
+      bits = pgm_read_byte(&bitmap[bo + bit / 8]) << (bit & 7);
+      for (xx = x0; xx < x1; xx++) {
         if (bits & 0x80) {
           if (size_x == 1 && size_y == 1) {
-            writePixel(x + xo + xx, y + yo + yy, color);
+            writePixel(left + xx, top + yy, color);
           } else {
-            writeFillRect(x + (xo16 + xx) * size_x, y + (yo16 + yy) * size_y,
-                          size_x, size_y, color);
+            writeFillRect(left + xx * size_x, top + yy * size_y, size_x,
+                          size_y, color);
           }
         }
         bits <<= 1;
+        if (!(++bit & 7) && xx + 1 < x1)
+          bits = pgm_read_byte(&bitmap[bo + bit / 8]);
       }
     }
     endWrite();
@@ -1853,6 +1917,118 @@ void GFXcanvas1::fillScreen(uint16_t color) {
   }
 }
 
+/**************************************************************************/
+/*!
+   @brief   Draw packed 1-bit source with blit(), in the mode that matches
+   drawing it a pixel at a time
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  Source bytes
+    @param    bit     Bit of the source the top left pixel is at
+    @param    stride  Bits from one row of the source to the next
+    @param    w   Width in pixels
+    @param    h   Height in pixels
+    @param    color Binary (on or off) color to draw set bits with
+    @param    bg Binary (on or off) color to draw clear bits with; if the same
+   as color, they're transparent
+    @returns  true if drawn, false if the caller has to draw it
+*/
+/**************************************************************************/
+bool GFXcanvas1::blitBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
+                            uint32_t bit, uint16_t stride, int16_t w,
+                            int16_t h, uint16_t color, uint16_t bg) {
+  if (bg == color)
+    return blit(x, y, bitmap, bit, stride, w, h,
+                color ? BLIT_OR : BLIT_AND | BLIT_INVERT);
+  if (!color == !bg)
+    return false; // both on or both off: a fill, not a copy
+  return blit(x, y, bitmap, bit, stride, w, h,
+              color ? BLIT_COPY : BLIT_COPY | BLIT_INVERT);
+}
+
+/**************************************************************************/
+/*!
+   @brief   Combine rows of packed 1-bit source, MSb first, with the canvas
+   a byte at a time: the source bits for each canvas byte are shifted into
+   place from at most two source bytes and masked in, so x and the source
+   bit need not be byte aligned. Clipped to the canvas
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  Source bytes
+    @param    bit     Bit of the source the top left pixel is at
+    @param    stride  Bits from one row of the source to the next
+    @param    w   Width in pixels
+    @param    h   Height in pixels
+    @param    mode  A BlitMode, optionally with BLIT_INVERT
+    @returns  true if drawn, false if the canvas is rotated (or has no
+   buffer), which blit() doesn't handle
+*/
+/**************************************************************************/
+bool GFXcanvas1::blit(int16_t x, int16_t y, const uint8_t *bitmap,
+                      uint32_t bit, uint16_t stride, int16_t w, int16_t h,
+                      uint8_t mode) {
+  if (!buffer || rotation)
+    return false;
+
+  // Clip, skipping the source bits that fall off the canvas
+  if (x < 0) {
+    bit += -x;
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    bit += (uint32_t)-y * stride;
+    h += y;
+    y = 0;
+  }
+  if (x + w > WIDTH)
+    w = WIDTH - x;
+  if (y + h > HEIGHT)
+    h = HEIGHT - y;
+  if (w <= 0 || h <= 0)
+    return true;
+
+  int16_t rowBytes = (WIDTH + 7) / 8;
+  uint8_t invert = (mode & BLIT_INVERT) ? 0xFF : 0x00;
+  mode &= ~BLIT_INVERT;
+
+  for (int16_t j = 0; j < h; j++, bit += stride) {
+    uint8_t *ptr = &buffer[(x / 8) + (y + j) * rowBytes];
+    const uint8_t *src = &bitmap[bit / 8];
+    uint8_t shift = bit & 7; // of the next source bit, in its byte
+    uint8_t dx = x & 7;      // of the next canvas bit, in its byte
+    for (int16_t left = w; left > 0; ptr++, dx = 0) {
+      uint8_t n = min(8 - dx, left); // bits into this canvas byte
+      uint8_t bits = *src << shift;
+      if (shift + n > 8) // the rest are in the next source byte
+        bits |= src[1] >> (8 - shift);
+      bits = (uint8_t)(bits ^ invert) >> dx;
+      uint8_t mask = (0xFF >> dx) & ~(0xFF >> (dx + n));
+
+      switch (mode) {
+      case BLIT_COPY:
+        *ptr = (*ptr & ~mask) | (bits & mask);
+        break;
+      case BLIT_OR:
+        *ptr |= bits & mask;
+        break;
+      case BLIT_AND:
+        *ptr &= bits | ~mask;
+        break;
+      case BLIT_XOR:
+        *ptr ^= bits & mask;
+        break;
+      }
+
+      shift += n;
+      src += shift >> 3;
+      shift &= 7;
+      left -= n;
+    }
+  }
+  return true;
+}
+
 /**************************************************************************/
 /*!
    @brief  Speed optimized vertical line drawing
@@ -2067,6 +2243,353 @@ void GFXcanvas1::drawFastRawHLine(int16_t x, int16_t y, int16_t w,
   }
 }
 
+/**************************************************************************/
+/*!
+   @brief    Instatiate a GFX column-major 1-bit canvas context for graphics
+   @param    w   Display width, in pixels
+   @param    h   Display height, in pixels (up to 8)
+*/
+/**************************************************************************/
+GFXcanvasColumns::GFXcanvasColumns(uint16_t w, uint16_t h)
+    : Adafruit_GFX(w, h > 8 ? 8 : h) {
+  if ((buffer = (uint8_t *)malloc(w))) {
+    memset(buffer, 0, w);
+  }
+}
+
+/**************************************************************************/
+/*!
+   @brief    Delete the canvas, free memory
+*/
+/**************************************************************************/
+GFXcanvasColumns::~GFXcanvasColumns(void) {
+  if (buffer)
+    free(buffer);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw a pixel to the canvas framebuffer
+    @param  x     x coordinate
+    @param  y     y coordinate
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvasColumns::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (buffer) {
+    if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+      return;
+
+    int16_t t;
+    switch (rotation) {
+    case 1:
+      t = x;
+      x = WIDTH - 1 - y;
+      y = t;
+      break;
+    case 2:
+      x = WIDTH - 1 - x;
+      y = HEIGHT - 1 - y;
+      break;
+    case 3:
+      t = x;
+      x = y;
+      y = HEIGHT - 1 - t;
+      break;
+    }
+
+    if (color)
+      buffer[x] |= 1 << y;
+    else
+      buffer[x] &= ~(1 << y);
+  }
+}
+
+/**********************************************************************/
+/*!
+        @brief    Get the pixel color value at a given coordinate
+        @param    x   x coordinate
+        @param    y   y coordinate
+        @returns  The desired pixel's binary color value, either 0x1 (on) or 0x0
+   (off)
+*/
+/**********************************************************************/
+bool GFXcanvasColumns::getPixel(int16_t x, int16_t y) const {
+  int16_t t;
+  switch (rotation) {
+  case 1:
+    t = x;
+    x = WIDTH - 1 - y;
+    y = t;
+    break;
+  case 2:
+    x = WIDTH - 1 - x;
+    y = HEIGHT - 1 - y;
+    break;
+  case 3:
+    t = x;
+    x = y;
+    y = HEIGHT - 1 - t;
+    break;
+  }
+  return getRawPixel(x, y);
+}
+
+/**********************************************************************/
+/*!
+        @brief    Get the pixel color value at a given, unrotated coordinate.
+        @param    x   x coordinate
+        @param    y   y coordinate
+        @returns  The desired pixel's binary color value, either 0x1 (on) or 0x0
+   (off)
+*/
+/**********************************************************************/
+bool GFXcanvasColumns::getRawPixel(int16_t x, int16_t y) const {
+  if ((x < 0) || (y < 0) || (x >= WIDTH) || (y >= HEIGHT))
+    return 0;
+  if (buffer) {
+    return (buffer[x] >> y) & 1;
+  }
+  return 0;
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw rows of packed 1-bit source, MSb first, into the column
+   bytes: each source row sets (or clears) its one bit in the columns it
+   covers, with no per-pixel call. Clipped to the canvas
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  Source bytes
+    @param    bit     Bit of the source the top left pixel is at
+    @param    stride  Bits from one row of the source to the next
+    @param    w   Width in pixels
+    @param    h   Height in pixels
+    @param    color Binary (on or off) color to draw set bits with
+    @param    bg Binary (on or off) color to draw clear bits with; if the same
+   as color, they're transparent
+    @returns  true if drawn, false if the caller has to draw it
+*/
+/**************************************************************************/
+bool GFXcanvasColumns::blitBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
+                                  uint32_t bit, uint16_t stride, int16_t w,
+                                  int16_t h, uint16_t color, uint16_t bg) {
+  if (!buffer || rotation)
+    return false;
+  if (bg != color && !color == !bg)
+    return false; // both on or both off: a fill, not a copy
+
+  // Clip, skipping the source bits that fall off the canvas
+  if (x < 0) {
+    bit += -x;
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    bit += (uint32_t)-y * stride;
+    h += y;
+    y = 0;
+  }
+  if (x + w > WIDTH)
+    w = WIDTH - x;
+  if (y + h > HEIGHT)
+    h = HEIGHT - y;
+  if (w <= 0 || h <= 0)
+    return true;
+
+  uint8_t *columns = &buffer[x];
+  for (int16_t j = 0; j < h; j++, bit += stride) {
+    uint8_t row = 1 << (y + j);
+    // opaque: start the row as the background, then draw the set bits over it
+    if (bg != color) {
+      for (int16_t i = 0; i < w; i++)
+        columns[i] = bg ? columns[i] | row : columns[i] & ~row;
+    }
+    const uint8_t *src = &bitmap[bit / 8];
+    uint8_t bits = *src++ << (bit & 7);
+    uint8_t left = 8 - (bit & 7); // bits left in 'bits'
+    for (int16_t i = 0; i < w; i++) {
+      if (!left) {
+        bits = *src++;
+        left = 8;
+      }
+      if (bits & 0x80)
+        columns[i] = color ? columns[i] | row : columns[i] & ~row;
+      bits <<= 1;
+      left--;
+    }
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fill the framebuffer completely with one color
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvasColumns::fillScreen(uint16_t color) {
+  if (buffer) {
+    memset(buffer, color ? (1 << HEIGHT) - 1 : 0x00, WIDTH);
+  }
+}
+
+/**************************************************************************/
+/*!
+   @brief  Speed optimized vertical line drawing
+   @param  x      Line horizontal start point
+   @param  y      Line vertical start point
+   @param  h      Length of vertical line to be drawn, including first point
+   @param  color  Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvasColumns::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                     uint16_t color) {
+
+  if (h < 0) { // Convert negative heights to positive equivalent
+    h *= -1;
+    y -= h - 1;
+    if (y < 0) {
+      h += y;
+      y = 0;
+    }
+  }
+
+  // Edge rejection (no-draw if totally off canvas)
+  if ((x < 0) || (x >= width()) || (y >= height()) || ((y + h - 1) < 0)) {
+    return;
+  }
+
+  if (y < 0) { // Clip top
+    h += y;
+    y = 0;
+  }
+  if (y + h > height()) { // Clip bottom
+    h = height() - y;
+  }
+
+  if (getRotation() == 0) {
+    drawFastRawVLine(x, y, h, color);
+  } else if (getRotation() == 1) {
+    int16_t t = x;
+    x = WIDTH - 1 - y;
+    y = t;
+    x -= h - 1;
+    drawFastRawHLine(x, y, h, color);
+  } else if (getRotation() == 2) {
+    x = WIDTH - 1 - x;
+    y = HEIGHT - 1 - y;
+
+    y -= h - 1;
+    drawFastRawVLine(x, y, h, color);
+  } else if (getRotation() == 3) {
+    int16_t t = x;
+    x = y;
+    y = HEIGHT - 1 - t;
+    drawFastRawHLine(x, y, h, color);
+  }
+}
+
+/**************************************************************************/
+/*!
+   @brief  Speed optimized horizontal line drawing
+   @param  x      Line horizontal start point
+   @param  y      Line vertical start point
+   @param  w      Length of horizontal line to be drawn, including first point
+   @param  color  Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvasColumns::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                     uint16_t color) {
+  if (w < 0) { // Convert negative widths to positive equivalent
+    w *= -1;
+    x -= w - 1;
+    if (x < 0) {
+      w += x;
+      x = 0;
+    }
+  }
+
+  // Edge rejection (no-draw if totally off canvas)
+  if ((y < 0) || (y >= height()) || (x >= width()) || ((x + w - 1) < 0)) {
+    return;
+  }
+
+  if (x < 0) { // Clip left
+    w += x;
+    x = 0;
+  }
+  if (x + w >= width()) { // Clip right
+    w = width() - x;
+  }
+
+  if (getRotation() == 0) {
+    drawFastRawHLine(x, y, w, color);
+  } else if (getRotation() == 1) {
+    int16_t t = x;
+    x = WIDTH - 1 - y;
+    y = t;
+    drawFastRawVLine(x, y, w, color);
+  } else if (getRotation() == 2) {
+    x = WIDTH - 1 - x;
+    y = HEIGHT - 1 - y;
+
+    x -= w - 1;
+    drawFastRawHLine(x, y, w, color);
+  } else if (getRotation() == 3) {
+    int16_t t = x;
+    x = y;
+    y = HEIGHT - 1 - t;
+    y -= w - 1;
+    drawFastRawVLine(x, y, w, color);
+  }
+}
+
+/**************************************************************************/
+/*!
+   @brief    Speed optimized vertical line drawing into the raw canvas buffer:
+             one mask on one column byte
+   @param    x   Line horizontal start point
+   @param    y   Line vertical start point
+   @param    h   length of vertical line to be drawn, including first point
+   @param    color   Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvasColumns::drawFastRawVLine(int16_t x, int16_t y, int16_t h,
+                                        uint16_t color) {
+  // x & y already in raw (rotation 0) coordinates, no need to transform.
+  uint8_t mask = ((1 << h) - 1) << y;
+  if (color > 0) {
+    buffer[x] |= mask;
+  } else {
+    buffer[x] &= ~mask;
+  }
+}
+
+/**************************************************************************/
+/*!
+   @brief    Speed optimized horizontal line drawing into the raw canvas buffer
+   @param    x   Line horizontal start point
+   @param    y   Line vertical start point
+   @param    w   length of horizontal line to be drawn, including first point
+   @param    color   Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvasColumns::drawFastRawHLine(int16_t x, int16_t y, int16_t w,
+                                        uint16_t color) {
+  // x & y already in raw (rotation 0) coordinates, no need to transform.
+  uint8_t *ptr = &buffer[x];
+  if (color > 0) {
+    for (int16_t i = 0; i < w; i++) {
+      ptr[i] |= 1 << y;
+    }
+  } else {
+    for (int16_t i = 0; i < w; i++) {
+      ptr[i] &= ~(1 << y);
+    }
+  }
+}
+
 /**************************************************************************/
 /*!
    @brief    Instatiate a GFX 8-bit canvas context for graphics
@@ -61,6 +61,13 @@ public:
   virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h,
                         uint16_t color);
 
+  // BLIT API
+  // MAY be overridden by a subclass that can draw packed 1-bit rows faster
+  // than a pixel at a time; drawBitmap() and drawChar() try it first.
+  virtual bool blitBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
+                          uint32_t bit, uint16_t stride, int16_t w, int16_t h,
+                          uint16_t color, uint16_t bg);
+
   // These exist only with Adafruit_GFX (no subclass overrides)
   void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
   void drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername,
@@ -320,12 +327,27 @@ private:
 /// A GFX 1-bit canvas context for graphics
 class GFXcanvas1 : public Adafruit_GFX {
 public:
+  /// How blit() combines the source bits with the canvas; BLIT_INVERT may
+  /// be ORed into any of them, to invert the source first
+  enum BlitMode : uint8_t {
+    BLIT_COPY = 0, ///< Replace
+    BLIT_OR = 1,   ///< Set where the source is set
+    BLIT_AND = 2,  ///< Clear where the source is clear
+    BLIT_XOR = 3,  ///< Invert where the source is set
+    BLIT_INVERT = 4
+  };
+
   GFXcanvas1(uint16_t w, uint16_t h);
   ~GFXcanvas1(void);
   void drawPixel(int16_t x, int16_t y, uint16_t color);
   void fillScreen(uint16_t color);
   void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
   void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  bool blitBitmap(int16_t x, int16_t y, const uint8_t *bitmap, uint32_t bit,
+                  uint16_t stride, int16_t w, int16_t h, uint16_t color,
+                  uint16_t bg);
+  bool blit(int16_t x, int16_t y, const uint8_t *bitmap, uint32_t bit,
+            uint16_t stride, int16_t w, int16_t h, uint8_t mode);
   bool getPixel(int16_t x, int16_t y) const;
   /**********************************************************************/
   /*!
@@ -354,6 +376,78 @@ private:
 #endif
 };
 
+/// A GFX 1-bit canvas context for graphics up to 8 pixels high, stored a byte
+/// per column (bit y is row y), for horizontally scrolled text: a column is
+/// one byte to index, clear or copy, and transpose8() turns 8 columns back
+/// into MSb-first rows
+class GFXcanvasColumns : public Adafruit_GFX {
+public:
+  GFXcanvasColumns(uint16_t w, uint16_t h);
+  ~GFXcanvasColumns(void);
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void fillScreen(uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  bool blitBitmap(int16_t x, int16_t y, const uint8_t *bitmap, uint32_t bit,
+                  uint16_t stride, int16_t w, int16_t h, uint16_t color,
+                  uint16_t bg);
+  bool getPixel(int16_t x, int16_t y) const;
+  /**********************************************************************/
+  /*!
+    @brief    Transpose 8 column bytes into 8 MSb-first row bytes: bit y of
+              column c becomes bit 7 - c of row y. Two 32-bit halves of the
+              8x8 bit matrix, swapping 1x1, 2x2 then 4x4 blocks (Hacker's
+              Delight 7-3). Inline, as it's called per 8 columns rendered
+    @param    columns   8 column bytes
+    @param    rows      8 row bytes out
+  */
+  /**********************************************************************/
+  static void transpose8(const uint8_t columns[8], uint8_t rows[8]) {
+    uint32_t x = (columns[0] << 24) | (columns[1] << 16) |
+                 (columns[2] << 8) | columns[3];
+    uint32_t y = (columns[4] << 24) | (columns[5] << 16) |
+                 (columns[6] << 8) | columns[7];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;
+    y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000CCCC;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC;
+    y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    // the transpose has the MSb of each column, the bottom row, first
+    rows[7] = x >> 24;
+    rows[6] = x >> 16;
+    rows[5] = x >> 8;
+    rows[4] = x;
+    rows[3] = y >> 24;
+    rows[2] = y >> 16;
+    rows[1] = y >> 8;
+    rows[0] = y;
+  }
+  /**********************************************************************/
+  /*!
+    @brief    Get a pointer to the internal buffer memory
+    @returns  A pointer to the allocated buffer, WIDTH column bytes
+  */
+  /**********************************************************************/
+  uint8_t *getBuffer(void) const { return buffer; }
+
+protected:
+  bool getRawPixel(int16_t x, int16_t y) const;
+  void drawFastRawVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawFastRawHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  uint8_t *buffer; ///< Raster data: no longer private, allow subclass access
+};
+
 /// A GFX 8-bit canvas context for graphics
 class GFXcanvas8 : public Adafruit_GFX {
 public:
@@ -0,0 +1,296 @@
+#include "Benchmark.h"
+
+// a message of the given length, of ordinary text; built without BENCHMARK too, for the golden images
+String benchMessage(int length)
+{
+    static const char words[] = "The quick brown fox jumps over the lazy dog 0123456789. ";
+    String s;
+    for (int i = 0; i < length; i++)
+    {
+        s += words[i % (sizeof(words) - 1)];
+    }
+    return s;
+}
+
+#if BENCHMARK
+
+#include "Adafruit_GFX.h"
+#include "Font5x7Fixed.h"
+#include "Font5x7FixedMono.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <chrono>
+#endif
+
+#define BENCH_MAX_ITERATIONS (1 << 24)
+
+// Timebase: CPU cycles on the device, which is exact and costs a single instruction to read; the
+// cycle counter wraps every 20s or so at 160 MHz, well beyond a batch
+#ifdef ESP_PLATFORM
+typedef uint32_t BenchTicks;
+static inline BenchTicks benchTicks() { return ESP.getCycleCount(); }
+static inline double benchNs(BenchTicks ticks) { return ticks * 1000.0 / ESP.getCpuFreqMHz(); }
+#else
+typedef uint64_t BenchTicks;
+static inline BenchTicks benchTicks()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+static inline double benchNs(BenchTicks ticks) { return ticks; }
+#endif
+
+static double timeBatch(const std::function<void(uint32_t)> &kernel, uint32_t n)
+{
+    BenchTicks start = benchTicks();
+    kernel(n);
+    return benchNs(benchTicks() - start);
+}
+
+void BenchReporter::run(const char *name, const std::function<void(uint32_t)> &kernel)
+{
+    // double the iterations until a batch takes a measurable time, then scale up to BENCH_BATCH_US
+    uint32_t n = 1;
+    double ns = timeBatch(kernel, n);
+    while (ns < BENCH_BATCH_US * 125.0 && n < BENCH_MAX_ITERATIONS)
+    {
+        n *= 2;
+        ns = timeBatch(kernel, n);
+    }
+    n = constrain(n * (BENCH_BATCH_US * 1000.0 / max(ns, 1.0)), 1.0, (double)BENCH_MAX_ITERATIONS);
+
+    // best of several batches, as anything else that runs can only add time
+    double best = 0;
+    for (int b = 0; b < BENCH_BATCHES; b++)
+    {
+        ns = timeBatch(kernel, n);
+        if (b == 0 || ns < best)
+        {
+            best = ns;
+        }
+    }
+    best /= n;
+
+    char line[256];
+    int len = snprintf(line, sizeof(line), "{\"name\":\"%s\",\"iterations\":%lu,\"ns\":%.1f", name,
+                       (unsigned long)n, best);
+    double was;
+    if (baselineNs(name, was) && was > 0)
+    {
+        double change = best / was - 1;
+        len += snprintf(line + len, sizeof(line) - len, ",\"baseline\":%.1f,\"change\":%.3f", was, change);
+        if (change > BENCH_TOLERANCE)
+        {
+            len += snprintf(line + len, sizeof(line) - len, ",\"regression\":true");
+            regressions++;
+        }
+    }
+    snprintf(line + len, sizeof(line) - len, "}");
+    write(line);
+
+#ifdef ESP_PLATFORM
+    vTaskDelay(1);  // let the idle task in, or the task watchdog fires on a long run
+#endif
+}
+
+int BenchReporter::finish()
+{
+    char line[64];
+    snprintf(line, sizeof(line), "{\"regressions\":%d}", regressions);
+    write(line);
+    return regressions;
+}
+
+// look up a kernel's time in the baseline report
+bool BenchReporter::baselineNs(const char *name, double &ns) const
+{
+    if (!baseline)
+    {
+        return false;
+    }
+
+    char key[96];
+    snprintf(key, sizeof(key), "{\"name\":\"%s\",", name);
+    const char *entry = strstr(baseline, key);
+    if (!entry)
+    {
+        return false;
+    }
+    const char *end = strchr(entry, '\n');
+    const char *value = strstr(entry, "\"ns\":");
+    if (!value || (end && value > end))
+    {
+        return false;
+    }
+    ns = atof(value + 5);
+    return true;
+}
+
+// The byte-shift scroll the driver used before the viewport: every byte of every row of a canvas as
+// wide as the whole message, per pixel scrolled. Kept as the reference for scroll/viewport/N
+static void scrollBitmap(GFXcanvas1 *canvas)
+{
+    int16_t width, height;
+    canvas->getSize(width, height);
+    uint8_t *buffer = canvas->getBuffer();
+
+    for (int y = 0; y < height; y++)
+    {
+        // data is stored MSb-first
+        int blocks = (width + 7) / 8;
+        uint8_t *ptr = &buffer[y * blocks];
+        bool bit = ptr[0] & 0x80;
+        for (int xb = blocks - 1; xb >= 0; xb--)
+        {
+            bool temp = ptr[xb] & 0x80;
+            ptr[xb] = (ptr[xb] << 1) | bit;
+            bit = temp;
+        }
+    }
+}
+
+int runBenchmarks(BenchWriter write, const char *baseline)
+{
+    BenchReporter bench(write, baseline);
+    char name[64];
+
+    // single pixels, across canvas widths: a module, the default panel, and the text ring
+    static const int widths[] = {60, 420, BENCH_CANVAS_COLUMNS};
+    for (int w : widths)
+    {
+        GFXcanvas1 canvas(w, 7);
+        snprintf(name, sizeof(name), "drawPixel/w%d", w);
+        bench.run(name, [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                canvas.drawPixel(i % w, (i / w) % 7, i & 1);
+            } });
+    }
+
+    // the same into the column canvas the text stream draws into
+    {
+        GFXcanvasColumns canvas(BENCH_CANVAS_COLUMNS, 7);
+        bench.run("drawPixel/columns", [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                canvas.drawPixel(i % BENCH_CANVAS_COLUMNS, (i / BENCH_CANVAS_COLUMNS) % 7, i & 1);
+            } });
+        canvas.setFont(&Font5x7Fixed);
+        bench.run("drawChar/5x7/columns", [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                canvas.drawChar(benchGlyphX(i, BENCH_CANVAS_COLUMNS), 7, 'A' + i % 58, 1, 1, 1);
+            } });
+    }
+
+    // a glyph at a time, across fonts; the classic font is 8 rows, clipped to 7
+    struct BenchFont
+    {
+        const char *name;
+        const GFXfont *font;
+        int y;
+    };
+    static const BenchFont fonts[] = {
+        {"5x7", &Font5x7Fixed, 7},
+        {"5x7mono", &Font5x7FixedMono, 7},
+        {"classic", nullptr, 0},
+    };
+    for (const BenchFont &f : fonts)
+    {
+        GFXcanvas1 canvas(BENCH_CANVAS_COLUMNS, 7);
+        canvas.setFont(f.font);
+        snprintf(name, sizeof(name), "drawChar/%s", f.name);
+        bench.run(name, [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                canvas.drawChar(benchGlyphX(i, BENCH_CANVAS_COLUMNS), f.y, 'A' + i % 58, 1, 1, 1);
+            } });
+    }
+
+    // a module-sized bitmap, at every bit offset
+    {
+        GFXcanvas1 canvas(420, 7);
+        static uint8_t bitmap[8 * 7];
+        memset(bitmap, 0x5A, sizeof(bitmap));
+        bench.run("drawBitmap/60x7", [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                canvas.drawBitmap(i % 360, 0, bitmap, 60, 7, 1);
+            } });
+    }
+
+    // whole messages through write(), into a display-wide canvas; most of a long message lands off it
+    static const int lengths[] = {16, 256, 4096};
+    for (int len : lengths)
+    {
+        GFXcanvas1 canvas(420, 7);
+        canvas.setFont(&Font5x7Fixed);
+        canvas.setTextWrap(false);
+        String text = benchMessage(len);
+        snprintf(name, sizeof(name), "write/%d", len);
+        bench.run(name, [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                canvas.setCursor(0, 7);
+                for (int c = 0; c < len; c++)
+                {
+                    canvas.write(text[c]);
+                }
+            } });
+    }
+
+    // the same long message into a column canvas, which draws glyphs a pixel at a time, scrolled
+    // so the window is in the middle of it: the glyphs either side cost only their clipping
+    {
+        GFXcanvasColumns canvas(420, 7);
+        canvas.setFont(&Font5x7Fixed);
+        canvas.setTextWrap(false);
+        String text = benchMessage(4096);
+        bench.run("write/4096/columns", [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                canvas.setCursor(-12000, 7);
+                for (int c = 0; c < 4096; c++)
+                {
+                    canvas.write(text[c]);
+                }
+            } });
+    }
+
+    // scrolling a pixel the old way, across message lengths; scroll/viewport/N is the same now
+    for (int len : scrollLengths)
+    {
+        String text = benchMessage(len);
+        GFXcanvas1 canvas(max(420, getTextWidth(&Font5x7Fixed, text)), 7);
+        canvas.setFont(&Font5x7Fixed);
+        canvas.setTextWrap(false);
+        canvas.setCursor(0, 7);
+        for (int c = 0; c < len; c++)
+        {
+            canvas.write(text[c]);
+        }
+        snprintf(name, sizeof(name), "scroll/bitmap/%d", len);
+        bench.run(name, [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                scrollBitmap(&canvas);
+            } });
+    }
+
+    benchmarkDisplay(bench);
+    return bench.finish();
+}
+
+#endif // BENCHMARK
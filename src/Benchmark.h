@@ -0,0 +1,69 @@
+#ifndef __Benchmark_h__
+#define __Benchmark_h__
+
+#include <Arduino.h>
+
+#include <functional>
+
+#include "gfxfont.h"
+
+// Micro-benchmarks of the render and scroll kernels, for tracking their cost as they change. Build with
+// -D BENCHMARK=1 to include them. Each kernel is timed (by the cycle counter on the device, the steady
+// clock on the host) over enough iterations to take about BENCH_BATCH_US, best of BENCH_BATCHES, and
+// reported as a line of JSON:
+//   {"name":"drawChar/5x7","iterations":2048,"ns":812.4}
+// Given a baseline (an earlier report), kernels more than BENCH_TOLERANCE slower are flagged:
+//   {"name":"drawChar/5x7","iterations":2048,"ns":990.1,"baseline":812.4,"change":0.219,"regression":true}
+// and the report ends with {"regressions":N}
+#ifndef BENCHMARK
+#define BENCHMARK 0
+#endif
+#ifndef BENCH_BATCH_US
+#define BENCH_BATCH_US 20000
+#endif
+#define BENCH_BATCHES 5
+#ifndef BENCH_TOLERANCE
+#define BENCH_TOLERANCE 0.10    // slower than the baseline by more than this is a regression
+#endif
+
+typedef void (*BenchWriter)(const char *line);
+
+class BenchReporter
+{
+public:
+    BenchReporter(BenchWriter write, const char *baseline) : write(write), baseline(baseline) {}
+
+    // times kernel(n), which runs the kernel n times, and reports the time per run
+    void run(const char *name, const std::function<void(uint32_t)> &kernel);
+    int finish();   // writes the summary; returns the number of regressions
+
+private:
+    bool baselineNs(const char *name, double &ns) const;
+
+    BenchWriter write;
+    const char *baseline;   // earlier report, or nullptr
+    int regressions = 0;
+};
+
+// Runs all the benchmarks. Returns the number of regressions against the baseline
+int runBenchmarks(BenchWriter write, const char *baseline = nullptr);
+String benchMessage(int length);    // ordinary text, for the kernels that take a message and the golden images
+int getTextWidth(const GFXfont *f, const String &text);     // in ScrollingDisplay.cpp
+
+// Canvas width for the per-glyph kernels: the text ring's, before it was rounded up to whole words.
+// The i'th glyph of a run goes BENCH_ADVANCE (Font5x7Fixed's) after the last, wrapping round to
+// column 0 at the last whole glyph that fits in a canvas or ring of the given width
+#define BENCH_CANVAS_COLUMNS 528
+#define BENCH_ADVANCE 6
+static inline int benchGlyphX(uint32_t i, int width)
+{
+    return (i * BENCH_ADVANCE) % (width - BENCH_ADVANCE);
+}
+
+// message lengths the old and new scroll are compared at, in scroll/bitmap/N and scroll/viewport/N
+static const int scrollLengths[] = {100, 1000, 4096};
+
+// the display driver's own kernels (stream rendering, frame composition), in ScrollingDisplay.cpp
+void benchmarkDisplay(BenchReporter &bench);
+
+#endif // __Benchmark_h__
@@ -1,4 +1,6 @@
 #include "ScrollingDisplay.h"
+#include "Trace.h"
+#include "Benchmark.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -11,193 +13,1742 @@
 #include "esp_attr.h"
 
 #include <atomic>
-#include <memory>
 
-// display characteristics
+// display characteristics. The module count and layout are set at runtime (see Geometry); buffers
+// and the scan timing are sized for the largest panel
 #define ROWS 7
-#define MODULE_COLUMNS 60 // 60 LED columns, but 64 shift register outputs
-#define MODULES 7         // was 8 display modules, but ones been removed
-#define COLUMNS (MODULE_COLUMNS * MODULES)
+#define MAX_MODULES 8           // up to 8 modules...
+#define MAX_REGISTER_BITS 64    // ...of up to 64 shift register outputs each
+#define MAX_COLUMNS (MAX_MODULES * MAX_REGISTER_BITS)
+#define MAX_ROW_BYTES (MAX_COLUMNS / 8)     // most bytes shifted out per row
+#define RING_COLUMNS ((MAX_COLUMNS + 16 + 31) & ~31)  // visible columns plus room for the glyph being
+                                                    // rendered, in whole words
+#define RING_WORDS (RING_COLUMNS / 32)
 
 // timer resource alloc stuff
 #define TIMER_GROUP TIMER_GROUP_0
 #define TIMER_IDX TIMER_0
-#define TIMER_DIVIDER 80 // 80 MHz / 80 = 1 MHz (1 tick = 1 µs)
-#define TIMER_INTERVAL_US 300   // this is what I'm referring to as "ticks"
+#define TIMER_DIVIDER 80 // 80 MHz / 80 = 1 MHz (1 count = 1 µs)
 
+// The timer free-runs as the timebase for all output, and its alarm is programmed as a one-shot for
+// the next thing that has to happen (OE off, next row, next frame), rather than interrupting
+// periodically. Times are in µs on this timebase.
 #define FRAME_RATE 60
-//#define TICKS_PER_ROW ((1000000 / FRAME_RATE / TIMER_INTERVAL_US + ROWS / 2) / ROWS) 
-//#define TICKS_PER_TRANSACTION (((COLUMNS * 1000000UL + SPI_SPEED - 1) / SPI_SPEED + TIMER_INTERVAL_US - 1) / TIMER_INTERVAL_US)
-#define TICKS_PER_TRANSACTION 3
-#define TICKS_PER_FRAME (1000000 / FRAME_RATE / TIMER_INTERVAL_US)
+#define FRAME_US (1000000 / FRAME_RATE)
+#define SPIN_US 20      // waits shorter than this are busy-waited, as an interrupt would be late anyway
+
+// Scan mode. Normally a row is shifted in, latched by the rising edge of CS at the end of the SPI
+// transfer, then lit, so the LEDs are dark while shifting. In pipelined mode the latch is driven
+// by hand, so the next row is shifted in while the current one is lit, and latched at the row
+// boundary, so OE can take all of each row slot rather than what the shift leaves.
+#ifndef SCAN_PIPELINED
+#define SCAN_PIPELINED 0
+#endif
+
+// Optionally, run the whole row scan (row select, SPI kick, latch, OE) inside the timer interrupt,
+// so Wi-Fi and other task activity can't delay it, and the only task is the render task. The SPI
+// peripheral is then driven directly rather than through the driver's queue, which isn't usable
+// from an ISR; a row fits in its 64 byte data buffer, so no DMA is needed.
+#ifndef SCAN_IN_ISR
+#define SCAN_IN_ISR 0
+#endif
+#if SCAN_IN_ISR
+#include "hal/spi_ll.h"
+#include "hal/gpio_ll.h"
+#endif
+
+// Grayscale by binary code modulation. With GRAYSCALE_BITS > 1, text is rendered into an 8 bit
+// canvas and each row is sent as that many bitplanes, plane p being lit for OE_US >> (bits-1-p),
+// so the most significant plane gets the full OE_US. Each row is scanned once per plane, which
+// multiplies the SPI traffic and scan steps per frame by GRAYSCALE_BITS (checked below against the
+// frame time), and the render task unpacks 8 bit pixels into planes on every scroll step. Short
+// planes are shorter than the task wake-up latency, so use SCAN_IN_ISR with more than 2 bits.
+#ifndef GRAYSCALE_BITS
+#define GRAYSCALE_BITS 1
+#endif
+static_assert(GRAYSCALE_BITS >= 1 && GRAYSCALE_BITS <= 4, "1 to 4 grayscale bits");
+#define SLOTS (ROWS * GRAYSCALE_BITS)   // scan slots per frame, in row order then plane order
+#define OE_SLOT_US(s) (OE_US >> (GRAYSCALE_BITS - 1 - (s) % GRAYSCALE_BITS))
+#define OE_TOTAL_US (2 * OE_US - (OE_US >> (GRAYSCALE_BITS - 1)))  // OE per row, all planes
 
 // SPI
 #define SPI_HOST SPI2_HOST  // use HSPI
 #define SPI_SPEED 2000000
-static void *dmaBuff = nullptr;
-static spi_transaction_t spiTrans = {};
 
-// stuff for our task
+// Timing model, for checking the scan order at compile time. The scan waits for each SPI transfer to
+// complete rather than for a fixed time. Per frame, for each slot s (a row, or a row's bitplane):
+//   normal:    SLOTS x | select r, shift s, CS latches s on completion | OE on (OE_SLOT_US) |
+//   pipelined: shift 0, then
+//              SLOTS x | OE off, latch s, select r, OE on, shift s+1 ... | OE off at OE_SLOT_US | ROW_US
+// then idle until FRAME_US. Latching and row select only ever happen with OE off, and in pipelined
+// mode the shift of row r+1 has to complete within the row slot, before it's latched (if it somehow
+// doesn't, the latch waits for it). Allow SCAN_MARGIN_US per transfer for interrupt and wake-up
+// latency. OE_US, the LED on time per row at full brightness, is then whatever's left of the frame
+// less FRAME_MARGIN_US, shared between the planes as their weights. (The original controller lit
+// each row for only 300 us of its 60 Hz frame, leaving the panel dark 87% of the time.)
+#define SCAN_MARGIN_US 50
+#define FRAME_MARGIN_US 500     // for the frame start's wake-up latency
+#define SPI_TRANSFER_US ((MAX_ROW_BYTES * 8 * 1000000UL + SPI_SPEED - 1) / SPI_SPEED) // the longest row
+#if SCAN_PIPELINED
+#define OE_US ((FRAME_US - FRAME_MARGIN_US - SPI_TRANSFER_US - SCAN_MARGIN_US) / SLOTS)
+#define ROW_US (OE_US > SPI_TRANSFER_US + SCAN_MARGIN_US ? OE_US : SPI_TRANSFER_US + SCAN_MARGIN_US)
+#define SCAN_US (SPI_TRANSFER_US + SCAN_MARGIN_US + SLOTS * ROW_US)
+#else
+#define OE_US (((FRAME_US - FRAME_MARGIN_US) / ROWS - GRAYSCALE_BITS * (SPI_TRANSFER_US + SCAN_MARGIN_US)) * \
+               (1 << (GRAYSCALE_BITS - 1)) / ((1 << GRAYSCALE_BITS) - 1))
+#define ROW_US (SPI_TRANSFER_US + SCAN_MARGIN_US + OE_US)
+#define SCAN_US (ROWS * (GRAYSCALE_BITS * (SPI_TRANSFER_US + SCAN_MARGIN_US) + OE_TOTAL_US))
+#endif
+static_assert(ROW_US >= SPI_TRANSFER_US + SCAN_MARGIN_US, "row shift doesn't fit in a row slot");
+static_assert(OE_US <= ROW_US, "OE longer than the row slot");
+static_assert(SCAN_US + FRAME_MARGIN_US <= FRAME_US, "rows don't fit in a frame");
+static_assert(OE_SLOT_US(0) > 0, "too many grayscale bits for OE_US");
+#if SCAN_IN_ISR
+static_assert(MAX_ROW_BYTES <= 64, "a row has to fit in the SPI data buffer");
+#endif
+#if !SCAN_IN_ISR
+static spi_transaction_t slotTrans[3][SLOTS];   // prepared transaction for every slot of every frame
+static bool spiPending = false;                 // transaction queued, result not yet collected
+static int64_t spiStartTime = 0;                // when the pending transaction was queued
+static volatile int64_t spiDoneTime = 0;        // set by the post-transaction callback
+#endif
+static std::atomic<uint32_t> spiTransferUs(0);  // stats
+static std::atomic<uint32_t> spiTransferMaxUs(0);
+
+// stuff for our tasks
 static String text("Hello");
 static std::atomic<bool> updateText(true);
-static std::atomic<int> scrollDelay(50);
-static std::atomic<uint32_t> tickCount(0);
+static std::atomic<uint32_t> scrollSpeed(20000);   // milli-pixels per second
+static std::atomic<uint8_t> textLevel(255);         // text brightness, in grayscale builds
+static std::atomic<uint8_t> brightness(255);        // global brightness, scales OE within its slot
+static ScrollingDisplayIntf::Zone zoneConfig[ScrollingDisplayIntf::MaxZones];  // layout from setZones()
+static int zoneCount = 0;                           // 0 for the single message layout
+static std::atomic<bool> updateZones(false);
+static ScrollingDisplayIntf::PlaylistItem playlistConfig[ScrollingDisplayIntf::MaxPlaylistItems];   // from setPlaylist()
+static int playlistCount = 0;
+static std::atomic<bool> updatePlaylist(false);
+static DRAM_ATTR uint32_t oeSlotUs[GRAYSCALE_BITS]; // OE time for each plane at the current brightness
+static std::atomic<uint32_t> timerInterrupts(0);
+static std::atomic<uint32_t> wakeLatencyAvgUs(0);   // how late the scan ran after its alarm
+static std::atomic<uint32_t> wakeLatencyMaxUs(0);
+
+// metrics. Each histogram only has one writer (the scan, or the render task), and they're read
+// in a critical section, which on this single core chip is enough for a consistent copy
+static ScrollingDisplayIntf::Histogram wakeLatencyHist = {{5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000}};
+static ScrollingDisplayIntf::Histogram slotOverrunHist = {{5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000}};
+static ScrollingDisplayIntf::Histogram framePeriodHist = {{FRAME_US - 100, FRAME_US - 20, FRAME_US + 20, FRAME_US + 100,
+                                                           FRAME_US + 500, FRAME_US + 1000, FRAME_US + 2000,
+                                                           FRAME_US + 5000, 2 * FRAME_US, 4 * FRAME_US}};
+static ScrollingDisplayIntf::Histogram scrollLagHist = {{FRAME_US / 4, FRAME_US / 2, FRAME_US, 3 * FRAME_US / 2, 2 * FRAME_US,
+                                                         3 * FRAME_US, 4 * FRAME_US, 6 * FRAME_US, 10 * FRAME_US, 20 * FRAME_US}};
+static ScrollingDisplayIntf::Histogram renderTimeHist = {{100, 200, 500, 1000, 2000, 5000, 10000, FRAME_US, 2 * FRAME_US, 4 * FRAME_US}};
+static std::atomic<uint32_t> frameCount(0);
+static std::atomic<uint32_t> framesLate(0);
+static std::atomic<uint32_t> framesRendered(0);
+static std::atomic<uint32_t> framesDropped(0);
+static std::atomic<uint32_t> spiQueueFailures(0);
+static uint64_t frameTimes[3];          // scroll clock time each frame was rendered at
+static uint64_t lastFrameStart = 0;
+static portMUX_TYPE metricsLock = portMUX_INITIALIZER_UNLOCKED;
 
 static spi_device_handle_t spi = nullptr;
+#if !SCAN_IN_ISR
 static TaskHandle_t highPrioTaskHandle = nullptr;
+#endif
+static TaskHandle_t renderTaskHandle = nullptr;
+
+// The visible window of every row, ready to send. Frames are triple buffered between the render task
+// (which owns the back buffer) and the high prio task (which owns the front buffer); the third is
+// passed between them through pendingFrame, so neither side ever waits on the other or allocates.
+// Frames are DMA capable and the SPI sends rows straight out of them; a frame is only rewritten when
+// the view changes.
+struct Frame
+{
+    uint8_t slots[SLOTS][(MAX_ROW_BYTES + 3) & ~3]; // padded so every row is word aligned for DMA
+};
+#define FRESH_FRAME 0x80    // pendingFrame flag: buffer holds a frame that hasn't been shown yet
+static DMA_ATTR Frame frames[3];
+static std::atomic<uint8_t> pendingFrame(1);
+
+// Zones are composited into a line per row before it goes into the frame; static zones are drawn
+// into the base lines once, when the layout is set, and each frame starts from a copy of them.
+// Mono lines are MSb-first 32 bit words, so zones are inserted a word at a time; the spare word
+// lets an insert that ends in the last word write past it
+#define LINE_WORDS ((MAX_ROW_BYTES + 3) / 4)
+#if GRAYSCALE_BITS > 1
+static uint8_t baseLines[ROWS][MAX_COLUMNS];
+#else
+static uint32_t baseLines[ROWS][LINE_WORDS + 1];
+#endif
+
+// Panel geometry. Lines are composited in display columns, then remapped into the order the bits are
+// shifted out: module m takes registerBits of the row, at slot m (or from the other end, if the chain
+// is reversed), with its LED columns first and mirrored if need be. The remap is a run per module,
+// and neighbouring modules that line up merge into one run, so a plain chain is a single copy
+struct RemapRun
+{
+    uint16_t src;       // first display column
+    uint16_t dst;       // first bit of the shifted-out row
+    uint16_t count;     // columns
+    bool mirrored;      // goes right to left
+};
+static ScrollingDisplayIntf::Geometry geometry;
+static int columns = 0;         // LED columns across the display
+static int rowBytes = 0;        // bytes shifted out per row
+static RemapRun remapRuns[MAX_MODULES];
+static int remapRunCount = 0;
+
+// the 32 bits of a line from column x, first one in the MSb
+uint32_t inline lineBits(const uint32_t *line, int x)
+{
+    const uint32_t *w = &line[x >> 5];
+    int shift = x & 31;
+    return shift ? (w[0] << shift) | (w[1] >> (32 - shift)) : w[0];
+}
+
+// The 32 bits of a mono ring row from column x, first one in the MSb. Rows are MSb-first bytes, so
+// big-endian words; each is a whole number of words and word aligned, so the wrap falls between words
+// and the funnel shift never straddles it
+uint32_t inline ringBits(const uint32_t *row, int x)
+{
+    int i = x >> 5;
+    int shift = x & 31;
+    uint32_t w = __builtin_bswap32(row[i]);
+    if (shift)
+    {
+        w = (w << shift) | (__builtin_bswap32(row[i + 1 < RING_WORDS ? i + 1 : 0]) >> (32 - shift));
+    }
+    return w;
+}
+
+uint32_t inline reverseBits(uint32_t w)
+{
+    w = ((w >> 1) & 0x55555555) | ((w & 0x55555555) << 1);
+    w = ((w >> 2) & 0x33333333) | ((w & 0x33333333) << 2);
+    w = ((w >> 4) & 0x0F0F0F0F) | ((w & 0x0F0F0F0F) << 4);
+    return __builtin_bswap32(w);
+}
+
+// forward refs
+void insertBits(uint32_t *line, int x, const uint8_t *src, int count);
+void insertWord(uint32_t *line, int x, uint32_t w, int n);
+void copyPlanes(Frame &frame, int r, const uint8_t *row, uint8_t level);
+void initSPI();
+void buildRemap();
+#if !SCAN_IN_ISR
+void transmitSlot(uint8_t frame, int s);
+void waitSPI();
+#endif
+int getTextWidth(const GFXfont *f, const String &text);
+
+#if GRAYSCALE_BITS == 1
+// Glyphs pre-rendered into columns the way the stream draws them (from the baseline at row 7, bit r
+// for row r), so drawing one into the ring is a copy of its columns rather than a clear, then a
+// drawPixel() per pixel.
+// A font is cached on first use, in the render task, and stays cached; fonts past GLYPH_CACHE_FONTS,
+// too big for the cache, or with glyphs that reach outside their advance (which a copy of the advance
+// would cut off) are drawn with drawChar()
+#define GLYPH_CACHE_FONTS 2
+#define GLYPH_CACHE_COLUMNS 1024
+#define GLYPH_CACHE_REFUSED 4   // fonts remembered as not cacheable, so they aren't loaded again
+class GlyphCache
+{
+public:
+    static const GlyphCache *get(const GFXfont *f);
+    void draw(uint8_t *ring, int x, int c) const;
+
+private:
+    bool load(const GFXfont *f);
+
+    const GFXfont *font = nullptr;
+    uint16_t start[256];    // first column of each glyph; it has xAdvance of them
+    uint8_t columns[GLYPH_CACHE_COLUMNS];
+};
+#endif
+
+// Streaming text renderer. Rather than rasterising the whole message up front, only a ring of
+// RING_COLUMNS columns is kept, and each glyph is drawn into it just before it scrolls into view.
+// Memory use and the cost of changing the text are independent of the message length.
+// The message repeats with a period of max(window, text width), same as a full-width canvas.
+// It scrolls either way: the ring holds stream columns renderedFrom to renderedTo, with a cursor into
+// the message at each end, and glyphs are drawn at whichever end the window moves past. A cursor left
+// behind when the other end catches up with it is found again from that end when it's next needed.
+// Glyphs are ORed in, as print() into a canvas would draw them, so ink reaching outside a glyph's
+// advance overlaps its neighbour's rather than being cleared by it: columns are only cleared as the
+// ink first reaches them, and a column is only shown once no glyph left to draw can reach it.
+class TextStream
+{
+public:
+    TextStream() : ring(RING_COLUMNS, ROWS) {}
+
+    void begin(const GFXfont *f, const String &s, int windowColumns);
+    void advance(int pixels);   // negative to scroll right
+
+    // row data of the ring (MSb-first bits, or a byte per pixel in grayscale), and the ring column
+    // shown at the left of the display
+#if GRAYSCALE_BITS > 1
+    const uint8_t *row(int r) const { return &ring.getBuffer()[r * RING_COLUMNS]; }
+#else
+    const uint8_t *row(int r) const { return rows[r]; }
+#endif
+    int offset() const { return ringColumn(viewStart); }
+
+    // columns scrolled left since begin(), and the columns in one repeat of the message
+    int64_t position() const { return viewStart; }
+    int length() const { return period; }
+
+#if BENCHMARK && GRAYSCALE_BITS == 1
+    bool cacheGlyphs = true;    // cleared to benchmark rendering with drawChar(), as before the cache
+#endif
+
+private:
+    static int ringColumn(int64_t col);
+    int stepForward(int &index, int &col, int limit) const;
+    int stepBack(int &index, int &col, int limit) const;
+    void findFront();
+    void findBack();
+    void fill();
+    void fillBack();
+    void drawGlyph(int64_t pen, char c);
+    void clearTo(int64_t from, int64_t to);
+    void clearColumns(int x, int count);
+    void transposeColumns(int64_t col, int count);
+
+#if GRAYSCALE_BITS > 1
+    static constexpr uint16_t ink = 255;
+    GFXcanvas8 ring;
+#else
+    // glyphs are drawn into columns, a byte each, then transposed into the rows the display is
+    // composed from
+    static constexpr uint16_t ink = 1;
+    GFXcanvasColumns ring;
+    alignas(4) uint8_t rows[ROWS][RING_COLUMNS / 8];
+    const GlyphCache *glyphs = nullptr;     // the font's, if it's cached
+#endif
+    const GFXfont *font = nullptr;
+    String text;
+    int window = 0;         // visible columns
+    int textWidth = 0;
+    int inkLeft = 0;        // furthest the font's ink reaches left of the pen position (<= 0)...
+    int inkRight = 0;       // ...and right of the advance (>= 0)
+    int period = 0;         // columns per repeat of the message
+    // cursors into the message at each end of the ring: the character starting at renderedTo (or
+    // renderedFrom), and the column within the repeat it starts at. Each is valid unless the other end
+    // has since moved over it
+    int charIndex = 0;
+    int messageCol = 0;
+    bool frontValid = true;
+    int backIndex = 0;
+    int backCol = 0;
+    bool backValid = true;
+    // 64 bits, as RING_COLUMNS doesn't divide 2^32: ring positions taken from 32-bit counters would
+    // jump when they wrapped, after some 50 days of a message scrolling at 1 ms a pixel. Signed, as
+    // scrolling right from the start goes before column 0
+    int64_t viewStart = 0;      // stream column at the left of the display
+    int64_t renderedFrom = 0;   // stream columns from this...
+    int64_t renderedTo = 0;     // ...up to this are in the ring
+    int64_t inkFrom = 0;        // and the columns from this up to inkTo have been cleared, and have
+    int64_t inkTo = 0;          // the ink of every glyph drawn since
+};
+
+// current time on the display timebase
+uint64_t inline now()
+{
+    uint64_t t;
+    timer_get_counter_value(TIMER_GROUP, TIMER_IDX, &t);
+    return t;
+}
+
+// Brightness shortens the OE pulse within its slot, so the slots, frame rate and scroll timing don't
+// change. Picked up once per frame, so there's no per-row cost
+void IRAM_ATTR updateOeTimes()
+{
+    uint8_t level = brightness;
+    for (int p = 0; p < GRAYSCALE_BITS; p++)
+    {
+        oeSlotUs[p] = OE_SLOT_US(p) * level / 255;
+    }
+}
+
+void IRAM_ATTR recordHistogram(ScrollingDisplayIntf::Histogram &h, uint32_t us)
+{
+    int i = 0;
+    while (i < h.Buckets && us > h.bounds[i])
+    {
+        i++;
+    }
+    h.counts[i]++;
+    h.count++;
+    h.sum += us;
+}
+
+// record how late we ran after a timer alarm (a running average and the worst case)
+void IRAM_ATTR recordWakeLatency(uint32_t us)
+{
+    wakeLatencyAvgUs = (wakeLatencyAvgUs * 15 + us) / 16;
+    if (us > wakeLatencyMaxUs)
+    {
+        wakeLatencyMaxUs = us;
+    }
+    recordHistogram(wakeLatencyHist, us);
+}
+
+// the scan started a frame at time t, showing frame 'front'; fresh if the render task had just published it
+void IRAM_ATTR frameStarted(uint64_t t, uint8_t front, bool fresh)
+{
+    if (lastFrameStart)
+    {
+        recordHistogram(framePeriodHist, t - lastFrameStart);
+    }
+    lastFrameStart = t;
+    frameCount++;
+    TRACE_EVENT(TraceEvent::Frame);
+
+    if (fresh && t >= frameTimes[front])
+    {
+        recordHistogram(scrollLagHist, t - frameTimes[front]);
+    }
+}
+
+// a scan slot ran from start to end; record it if it took longer than its ROW_US
+void IRAM_ATTR slotEnded(uint64_t start, uint64_t end)
+{
+    if (end > start + ROW_US)
+    {
+        recordHistogram(slotOverrunHist, end - start - ROW_US);
+    }
+}
+
+#if SCAN_IN_ISR
+
+// ISR-resident scan. Each alarm runs the scan steps that are due, then sets the alarm for the next one
+enum class ScanStep : uint8_t
+{
+    FrameStart, // pick up the newest frame and start shifting the first slot
+    OeOn,       // (normal mode) slot has been latched by CS, light it
+    Latch,      // (pipelined mode) latch and light the slot that's been shifted in, shift the next
+    OeOff,      // LEDs off, move on to the next slot or frame
+};
+
+static ScanStep scanStep = ScanStep::FrameStart;
+static int scanSlot = 0;
+static uint8_t scanFront = 0;
+static uint64_t scanDue = 0;        // when the alarm was due
+static uint64_t scanFrameStart = 0;
+static uint64_t scanSlotStart = 0;
+static uint64_t scanKickTime = 0;   // when the current row started shifting out
+static uint32_t rowTransferUs = 0;  // time to shift out rowBytes; SPI_TRANSFER_US is for the longest row
+static spi_dev_t *spiHw = nullptr;
+
+void IRAM_ATTR setPin(int pin, int level)
+{
+    gpio_ll_set_level(&GPIO, (gpio_num_t)pin, level);
+}
+
+void IRAM_ATTR selectRowISR(int r)
+{
+    using PinDefs = ScrollingDisplayIntf::PinDefs;
+    setPin(PinDefs::r0, !!(r & 1));
+    setPin(PinDefs::r1, !!(r & 2));
+    setPin(PinDefs::r2, !!(r & 4));
+    TRACE_EVENT(TraceEvent::RowSelect, r);
+}
+
+// load a slot straight into the SPI data buffer and start shifting it out
+void IRAM_ATTR kickSlot(int s)
+{
+    spi_ll_clear_int_stat(spiHw);
+    spi_ll_write_buffer(spiHw, frames[scanFront].slots[s], rowBytes * 8);
+    spi_ll_apply_config(spiHw);
+    spi_ll_user_start(spiHw);
+    scanKickTime = timer_group_get_counter_value_in_isr(TIMER_GROUP, TIMER_IDX);
+    TRACE_EVENT(TraceEvent::SpiQueue);
+}
+
+// true once the row has been shifted out; also records how long it took
+bool IRAM_ATTR rowShifted(uint64_t t)
+{
+    if (!spi_ll_usr_is_done(spiHw))
+    {
+        return false;
+    }
+
+    TRACE_EVENT(TraceEvent::SpiDone);
+    uint32_t us = t - scanKickTime;
+    spiTransferUs = us;
+    if (us > spiTransferMaxUs)
+    {
+        spiTransferMaxUs = us;
+    }
+    return true;
+}
+
+// when to look again for a row that isn't shifted out yet: every µs for SPIN_US after it's due, so
+// the time it finished is recorded as it happens, then every SPIN_US
+uint64_t IRAM_ATTR shiftPoll(uint64_t t)
+{
+    return t < scanKickTime + rowTransferUs + SPIN_US ? t + 1 : t + SPIN_US;
+}
+
+// runs one step of the scan at time t, returning when the next one is due
+uint64_t IRAM_ATTR runScanStep(uint64_t t, BaseType_t *needToYield)
+{
+    using PinDefs = ScrollingDisplayIntf::PinDefs;
+
+    switch (scanStep)
+    {
+    case ScanStep::FrameStart:
+        // swap in the next frame, if the render task has published one
+        {
+            bool fresh = pendingFrame & FRESH_FRAME;
+            if (fresh)
+            {
+                scanFront = pendingFrame.exchange(scanFront) & ~FRESH_FRAME;
+            }
+            frameStarted(t, scanFront, fresh);
+        }
+        updateOeTimes();
+        scanSlot = 0;
+        kickSlot(0);
+#if SCAN_PIPELINED
+        scanStep = ScanStep::Latch;
+#else
+        scanSlotStart = t;
+        selectRowISR(0);
+        scanStep = ScanStep::OeOn;
+#endif
+        return scanKickTime + rowTransferUs;
+
+    case ScanStep::OeOn:
+        if (!rowShifted(t))
+        {
+            return shiftPoll(t);    // not shifted in (and latched) yet
+        }
+        if (oeSlotUs[scanSlot % GRAYSCALE_BITS])
+        {
+            setPin(PinDefs::oe, LOW);   // LEDs on
+            TRACE_EVENT(TraceEvent::OeOn, scanSlot);
+        }
+        scanStep = ScanStep::OeOff;
+        return t + oeSlotUs[scanSlot % GRAYSCALE_BITS];
+
+    case ScanStep::Latch:
+        if (!rowShifted(t))
+        {
+            return shiftPoll(t);    // the row has to be shifted in before it's latched
+        }
+        if (scanSlot > 0)
+        {
+            slotEnded(scanSlotStart, t);    // the last slot ends as this one's latched
+        }
+
+        // OE is off here; latch the row that's just been shifted in, and show it
+        setPin(PinDefs::cs, HIGH);
+        setPin(PinDefs::cs, LOW);
+        selectRowISR(scanSlot / GRAYSCALE_BITS);
+        if (oeSlotUs[scanSlot % GRAYSCALE_BITS])
+        {
+            setPin(PinDefs::oe, LOW);   // LEDs on
+            TRACE_EVENT(TraceEvent::OeOn, scanSlot);
+        }
+        scanSlotStart = t;
+
+        // shift in the next slot while this one is lit
+        if (scanSlot + 1 < SLOTS)
+        {
+            kickSlot(scanSlot + 1);
+        }
+        scanStep = ScanStep::OeOff;
+        return t + oeSlotUs[scanSlot % GRAYSCALE_BITS];
+
+    case ScanStep::OeOff:
+        setPin(PinDefs::oe, HIGH);  // LEDs off
+        TRACE_EVENT(TraceEvent::OeOff);
+        if (++scanSlot < SLOTS)
+        {
+#if SCAN_PIPELINED
+            scanStep = ScanStep::Latch;
+            return max(scanSlotStart + ROW_US, t);
+#else
+            slotEnded(scanSlotStart, t);
+            scanSlotStart = t;
+            selectRowISR(scanSlot / GRAYSCALE_BITS);
+            kickSlot(scanSlot);
+            scanStep = ScanStep::OeOn;
+            return scanKickTime + rowTransferUs;
+#endif
+        }
+
+        // frame done; let the render task prepare the next one while we wait out the rest of this one
+        vTaskNotifyGiveFromISR(renderTaskHandle, needToYield);
+        scanStep = ScanStep::FrameStart;
+        scanFrameStart += FRAME_US;
+        if (scanFrameStart < t)
+        {
+            scanFrameStart = t;     // fell more than a frame behind; don't try to catch up
+            framesLate++;
+        }
+        return scanFrameStart;
+    }
+
+    return t;
+}
+
+// one-shot timer alarm runs the scan steps that are due. Steps that are only a few µs apart are
+// run back to back here rather than taking another interrupt
+bool IRAM_ATTR onTimer(void *arg)
+{
+    BaseType_t needToYield = pdFALSE;
+    uint64_t t = timer_group_get_counter_value_in_isr(TIMER_GROUP, TIMER_IDX);
+    recordWakeLatency(t - scanDue);
+    TRACE_EVENT(TraceEvent::TimerIsr);
+
+    uint64_t due = scanDue;
+    do
+    {
+        while (t < due)
+        {
+            t = timer_group_get_counter_value_in_isr(TIMER_GROUP, TIMER_IDX);
+        }
+        due = runScanStep(t, &needToYield);
+        t = timer_group_get_counter_value_in_isr(TIMER_GROUP, TIMER_IDX);
+    } while (due <= t + SPIN_US);
+
+    scanDue = due;
+    timer_group_set_alarm_value_in_isr(TIMER_GROUP, TIMER_IDX, due);
+    timerInterrupts++;
+
+    return needToYield;
+}
+
+#else
+
+// one-shot timer alarm wakes our high prio task at the time it asked for
+bool IRAM_ATTR onTimer(void *arg)
+{
+    BaseType_t needToYield = pdFALSE;
+    TRACE_EVENT(TraceEvent::TimerIsr);
+    if (highPrioTaskHandle)
+    {
+        vTaskNotifyGiveFromISR(highPrioTaskHandle, &needToYield);
+    }
+
+    timerInterrupts++;
+
+    return needToYield;
+}
+
+// waits until time t, sleeping on a timer alarm unless it's very close
+void waitUntil(uint64_t t)
+{
+    if (t > now() + SPIN_US)
+    {
+        ulTaskNotifyTake(pdTRUE, 0);    // discard any stale wake-up
+        timer_set_alarm_value(TIMER_GROUP, TIMER_IDX, t);
+        timer_set_alarm(TIMER_GROUP, TIMER_IDX, TIMER_ALARM_EN);
+        while (t > now() + SPIN_US)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        uint64_t woke = now();
+        TRACE_EVENT(TraceEvent::TaskWake, 0);
+        if (woke >= t)
+        {
+            recordWakeLatency(woke - t);
+        }
+    }
+
+    while (now() < t)
+    {
+    }
+}
+
+// set the row select lines
+void inline selectRow(int r)
+{
+    using PinDefs = ScrollingDisplayIntf::PinDefs;
+    digitalWrite(PinDefs::r0, !!(r & 1));
+    digitalWrite(PinDefs::r1, !!(r & 2));
+    digitalWrite(PinDefs::r2, !!(r & 4));
+    TRACE_EVENT(TraceEvent::RowSelect, r);
+}
+
+// High priority task: drives the display from the newest frame; never renders or allocates
+void highPrioTask(void *pvParameters)
+{
+    uint8_t front = 0;
+    uint64_t frameStart = now();
+
+    for (;;)
+    {
+        // swap in the next frame, if the render task has published one
+        bool fresh = pendingFrame & FRESH_FRAME;
+        if (fresh)
+        {
+            front = pendingFrame.exchange(front) & ~FRESH_FRAME;
+        }
+        frameStarted(now(), front, fresh);
+        updateOeTimes();
+        using PinDefs = ScrollingDisplayIntf::PinDefs;
+
+        uint64_t t;     // when the next OE period starts
+
+#if SCAN_PIPELINED
+        // preload the first row while the display is dark
+        transmitSlot(front, 0);
+        waitSPI();
+        t = now();
+
+        for (int s = 0; s < SLOTS; s++)
+        {
+            waitUntil(t);
+
+            // OE is off here; latch the row (or plane) that's just been shifted in, and show it
+            digitalWrite(PinDefs::cs, HIGH);
+            digitalWrite(PinDefs::cs, LOW);
+            selectRow(s / GRAYSCALE_BITS);
+            uint32_t oe = oeSlotUs[s % GRAYSCALE_BITS];
+            if (oe)
+            {
+                digitalWrite(PinDefs::oe, LOW);     // LEDs on
+                TRACE_EVENT(TraceEvent::OeOn, s);
+            }
+
+            // shift in the next one while this one is lit
+            if (s + 1 < SLOTS)
+            {
+                transmitSlot(front, s + 1);
+            }
+
+            waitUntil(t + oe);
+            digitalWrite(PinDefs::oe, HIGH);     // LEDs off
+            TRACE_EVENT(TraceEvent::OeOff);
+
+            waitSPI();  // the next row has to be shifted in before it's latched
+            uint64_t end = now();
+            slotEnded(t, end);
+            t = max(t + ROW_US, end);
+        }
+#else
+        for (int s = 0; s < SLOTS; s++)
+        {
+            uint64_t slotStart = now();
+            selectRow(s / GRAYSCALE_BITS);
+
+            // send the data, CS latches it when the transfer completes
+            transmitSlot(front, s);
+            waitSPI();
+
+            t = now();
+            uint32_t oe = oeSlotUs[s % GRAYSCALE_BITS];
+            if (oe)
+            {
+                digitalWrite(PinDefs::oe, LOW);     // LEDs on
+                TRACE_EVENT(TraceEvent::OeOn, s);
+            }
+            waitUntil(t + oe);
+            digitalWrite(PinDefs::oe, HIGH);     // LEDs off
+            TRACE_EVENT(TraceEvent::OeOff);
+            slotEnded(slotStart, now());
+        }
+#endif
+
+        // let the render task prepare the next frame while we wait out the rest of this one
+        xTaskNotifyGive(renderTaskHandle);
+        frameStart += FRAME_US;
+        if (frameStart < now())
+        {
+            frameStart = now();     // fell more than a frame behind; don't try to catch up
+            framesLate++;
+        }
+        waitUntil(frameStart);
+    }
+}
+
+#endif // SCAN_IN_ISR
+
+// A zone as the render task sees it
+struct ZoneState
+{
+    int x = 0;
+    int width = 0;
+    int skip = 0;               // columns into the stream's window that the zone shows from
+    uint32_t speed = 0;         // milli-pixels per second
+    bool reverse = false;       // scrolling right
+    uint64_t scrollAcc = 0;     // scroll position in nano-pixels, since the last whole pixel
+    TextStream *stream = nullptr;
+};
+
+// Plays the playlist in the single message layout, by swapping the zone's stream for the next item's.
+// The next item is primed in the frame after an item starts, so a switch or transition never has to
+// render a whole window in the frame it happens
+class PlaylistPlayer
+{
+public:
+    void take();
+    void start(ZoneState &zone);
+    bool active() const { return count > 0; }
+    uint32_t speed() const { return items[current].milliPixelsPerSecond; }
+    int advance(ZoneState &zone, uint32_t pixels, ZoneState *view);
+
+private:
+    void prime();
+    void next(ZoneState &zone);
+
+    ScrollingDisplayIntf::PlaylistItem items[ScrollingDisplayIntf::MaxPlaylistItems];
+    int count = 0;
+    int current = 0;
+    TextStream nextStream;
+    TextStream *upcoming = &nextStream; // stream for the next item; swapped with the zone's
+    bool primed = false;
+    int transition = -1;    // columns into the transition to the next item, or -1
+};
+
+// draw a static zone's text into the base lines
+void drawStaticZone(const ScrollingDisplayIntf::Zone &zone, const GFXfont *font)
+{
+    using Align = ScrollingDisplayIntf::Align;
+
+#if GRAYSCALE_BITS > 1
+    GFXcanvas8 canvas(zone.width, ROWS);
+    const uint16_t ink = 255;
+#else
+    GFXcanvas1 canvas(zone.width, ROWS);
+    const uint16_t ink = 1;
+#endif
+    if (!canvas.getBuffer())
+    {
+        return;
+    }
+    canvas.setFont(font);
+
+    int x = 0;
+    int textWidth = getTextWidth(font, zone.text);
+    if (zone.align == Align::Center)
+    {
+        x = (zone.width - textWidth) / 2;
+    }
+    else if (zone.align == Align::Right)
+    {
+        x = zone.width - textWidth;
+    }
+
+    for (int i = 0; i < (int)zone.text.length() && x < zone.width; i++)
+    {
+        char c = zone.text[i];
+        if (c >= font->first && c <= font->last)
+        {
+            canvas.drawChar(x, 7, c, ink, ink, 1);    // font is offset (default font is not)
+            x += font->glyph[c - font->first].xAdvance;
+        }
+    }
+
+    for (int r = 0; r < ROWS; r++)
+    {
+#if GRAYSCALE_BITS > 1
+        memcpy(&baseLines[r][zone.x], &canvas.getBuffer()[r * zone.width], zone.width);
+#else
+        insertBits(baseLines[r], zone.x, &canvas.getBuffer()[r * ((zone.width + 7) / 8)], zone.width);
+#endif
+    }
+}
+
+// set up for a layout of the first n zones of zoneConfig: static zones are drawn into the base lines,
+// and each scrolling zone gets a stream. Returns the number of scrolling zones
+int layoutZones(ZoneState *zones, int n)
+{
+    memset(baseLines, 0, sizeof(baseLines));
+
+    if (n == 0)
+    {
+        // single message; the render task starts its stream from the text (or the playlist)
+        zones[0].x = 0;
+        zones[0].width = columns;
+        zones[0].skip = 0;
+        zones[0].reverse = false;
+        zones[0].scrollAcc = 0;
+        return 1;
+    }
+
+    int count = 0;
+    for (int i = 0; i < n; i++)
+    {
+        const ScrollingDisplayIntf::Zone &zone = zoneConfig[i];
+        const GFXfont *font = zone.font ? zone.font : &Font5x7Fixed;
+        if (zone.milliPixelsPerSecond == 0)
+        {
+            drawStaticZone(zone, font);
+        }
+        else
+        {
+            ZoneState &z = zones[count++];
+            z.x = zone.x;
+            z.width = zone.width;
+            z.speed = zone.milliPixelsPerSecond;
+            z.reverse = zone.reverse;
+            z.scrollAcc = 0;
+            z.skip = 0;
+            z.stream->begin(font, zone.text, zone.width);
+        }
+    }
+    return count;
+}
+
+// composite row r of the static and scrolling zones into a frame
+void composeRow(Frame &frame, int r, ZoneState *zones, int count, uint8_t level)
+{
+#if GRAYSCALE_BITS > 1
+    uint8_t line[MAX_COLUMNS];
+    memcpy(line, baseLines[r], sizeof(line));
+    for (int i = 0; i < count; i++)
+    {
+        // the zone's window of the ring, in up to two pieces as it wraps
+        const uint8_t *row = zones[i].stream->row(r);
+        int offset = (zones[i].stream->offset() + zones[i].skip) % RING_COLUMNS;
+        int n = min(zones[i].width, RING_COLUMNS - offset);
+        memcpy(&line[zones[i].x], &row[offset], n);
+        memcpy(&line[zones[i].x + n], row, zones[i].width - n);
+    }
+
+    // into shift register order
+    uint8_t shifted[MAX_ROW_BYTES * 8] = {};
+    for (int i = 0; i < remapRunCount; i++)
+    {
+        const RemapRun &run = remapRuns[i];
+        if (run.mirrored)
+        {
+            for (int c = 0; c < run.count; c++)
+            {
+                shifted[run.dst + c] = line[run.src + run.count - 1 - c];
+            }
+        }
+        else
+        {
+            memcpy(&shifted[run.dst], &line[run.src], run.count);
+        }
+    }
+    copyPlanes(frame, r, shifted, level);
+#else
+    uint32_t line[LINE_WORDS + 1];
+    memcpy(line, baseLines[r], sizeof(line));
+    for (int i = 0; i < count; i++)
+    {
+        // the zone's window of the ring, a word at a time; any scroll position costs the same
+        const uint32_t *row = (const uint32_t *)zones[i].stream->row(r);
+        int offset = (zones[i].stream->offset() + zones[i].skip) % RING_COLUMNS;
+        for (int k = 0; k < zones[i].width; k += 32)
+        {
+            int x = offset + k;
+            if (x >= RING_COLUMNS)
+            {
+                x -= RING_COLUMNS;
+            }
+            insertWord(line, zones[i].x + k, ringBits(row, x), min(zones[i].width - k, 32));
+        }
+    }
+
+    // into shift register order, a word at a time
+    uint32_t shifted[LINE_WORDS + 1] = {};
+    for (int i = 0; i < remapRunCount; i++)
+    {
+        const RemapRun &run = remapRuns[i];
+        for (int k = 0; k < run.count; k += 32)
+        {
+            int n = min(run.count - k, 32);
+            uint32_t w;
+            if (run.mirrored)
+            {
+                // the matching columns from the other end, reversed; only the top n bits are used
+                w = reverseBits(lineBits(line, run.src + run.count - k - n)) << (32 - n);
+            }
+            else
+            {
+                w = lineBits(line, run.src + k);
+            }
+            insertWord(shifted, run.dst + k, w, n);
+        }
+    }
+
+    // frame rows are MSb-first bytes, i.e. big-endian words
+    uint32_t *dst = (uint32_t *)frame.slots[r];
+    for (int k = 0; k < (rowBytes + 3) / 4; k++)
+    {
+        dst[k] = __builtin_bswap32(shifted[k]);
+    }
+#endif
+}
+
+// take the playlist from setPlaylist(), while updatePlaylist is set
+void PlaylistPlayer::take()
+{
+    count = playlistCount;
+    for (int i = 0; i < count; i++)
+    {
+        items[i] = playlistConfig[i];
+    }
+}
+
+// start the playlist over in the zone, from the first item
+void PlaylistPlayer::start(ZoneState &zone)
+{
+    current = 0;
+    primed = false;
+    transition = -1;
+
+    if (count)
+    {
+        zone.stream->begin(&Font5x7Fixed, items[0].text, columns);
+        zone.scrollAcc = 0;
+    }
+}
+
+// render the start of the next item, ready to switch to
+void PlaylistPlayer::prime()
+{
+    upcoming->begin(&Font5x7Fixed, items[(current + 1) % count].text, columns);
+    primed = true;
+}
+
+// switch the zone over to the next item
+void PlaylistPlayer::next(ZoneState &zone)
+{
+    if (!primed)
+    {
+        prime();
+    }
+    std::swap(zone.stream, upcoming);
+    current = (current + 1) % count;
+    primed = false;
+    transition = -1;
+}
+
+// Scrolls the playlist on by some pixels, moving to the next item once the current one has dwelt, and
+// fills in the zones to show: the item's zone, or the outgoing and incoming items during a transition.
+// Returns the number of zones in view
+int PlaylistPlayer::advance(ZoneState &zone, uint32_t pixels, ZoneState *view)
+{
+    using Transition = ScrollingDisplayIntf::Transition;
+
+    if (!primed)
+    {
+        prime();
+    }
+
+    zone.stream->advance(pixels);
+    const ScrollingDisplayIntf::PlaylistItem &item = items[current];
+    uint32_t end = max<uint32_t>(item.dwell, 1) * zone.stream->length();
+    if (transition >= 0)
+    {
+        transition += pixels;
+    }
+    else if (zone.stream->position() >= end)
+    {
+        transition = zone.stream->position() - end;
+    }
+
+    // a cut is a transition that's over as soon as it starts; either way, carry any extra pixels over
+    int duration = item.transition == Transition::Cut ? 0 : columns;
+    if (transition >= duration)
+    {
+        int over = transition - duration;
+        next(zone);
+        zone.stream->advance(over);
+    }
+
+    view[0] = zone;
+    if (transition < 0)
+    {
+        return 1;
+    }
+
+    view[1] = zone;
+    view[1].stream = upcoming;
+    if (item.transition == Transition::Push)
+    {
+        // the outgoing item carries on scrolling out to the left, with the start of the next one behind it
+        view[0].width = columns - transition;
+        view[1].x = columns - transition;
+        view[1].width = transition;
+    }
+    else
+    {
+        // the next item is uncovered from the left, while the rest of the outgoing one carries on
+        view[0].x = transition;
+        view[0].skip = transition;
+        view[0].width = columns - transition;
+        view[1].width = transition;
+    }
+    return 2;
+}
+
+// Render task: handles text, layout and playlist changes and scrolling, publishing a new frame whenever
+// the view changes. Runs once per frame, woken by the high prio task (or the scan ISR).
+void renderTask(void *pvParameters)
+{
+    static ZoneState zones[ScrollingDisplayIntf::MaxZones];
+    static TextStream streams[ScrollingDisplayIntf::MaxZones];
+    static PlaylistPlayer player;
+    ZoneState view[2];  // zones in view during a playlist transition
+    int count = 1;      // scrolling zones
+    uint64_t lastScroll = now();
+    uint8_t back = 2;
+    uint8_t level = textLevel;
+
+    // The update flags belong to the setters: they only write the config while their flag is clear,
+    // so this task only reads it while the flag is set, and only ever clears the flags. What it needs
+    // again later, it keeps its own copy of
+    bool single = true;     // the single message layout
+    bool relayout = true;   // lay the single message out on the first frame
+    String message;         // 'text', as last taken; the single message restarts from it
+
+    for (int i = 0; i < ScrollingDisplayIntf::MaxZones; i++)
+    {
+        zones[i].stream = &streams[i];
+    }
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint64_t woke = now();
+        TRACE_EVENT(TraceEvent::TaskWake, 1);
+
+        bool changed = false;
+        bool restart = false;   // the single message, from the playlist or the text
+        bool taken = updateZones;
+        if (taken || relayout)
+        {
+            single = !taken || zoneCount == 0;
+            count = layoutZones(zones, single ? 0 : zoneCount);
+            if (taken)
+            {
+                updateZones = false;
+            }
+            relayout = false;
+            restart = true;
+            changed = true;
+            TRACE_EVENT(TraceEvent::TextSwap);
+        }
+
+        // the single message layout shows the playlist if there is one, otherwise the text at the scroll
+        // speed; either is taken whatever the layout, for when it's back to the single message
+        if (updatePlaylist)
+        {
+            player.take();
+            updatePlaylist = false;
+            restart = true;
+        }
+        if (updateText)
+        {
+            message = text;
+            updateText = false;
+            restart |= !player.active();
+        }
+        if (single && restart)
+        {
+            if (player.active())
+            {
+                player.start(zones[0]);
+            }
+            else
+            {
+                zones[0].stream->begin(&Font5x7Fixed, message, columns);
+            }
+            changed = true;
+            TRACE_EVENT(TraceEvent::TextSwap);
+        }
+        bool playing = single && player.active();
+        if (single)
+        {
+            zones[0].speed = playing && player.speed() ? player.speed() : scrollSpeed.load();
+        }
+
+        // Scroll clock: µs elapsed x milli-pixels/s gives nano-pixels. Advance by however many whole
+        // pixels are due, keeping the remainder, so the speed holds whatever the frame rate is
+        uint64_t t = now();
+        uint64_t elapsed = t - lastScroll;
+        lastScroll = t;
+        ZoneState *shown = zones;
+        int shownCount = count;
+        for (int i = 0; i < count; i++)
+        {
+            ZoneState &z = zones[i];
+            z.scrollAcc += elapsed * z.speed;
+            uint32_t pixels = z.scrollAcc / 1000000000ULL;
+            if (pixels)
+            {
+                z.scrollAcc %= 1000000000ULL;
+                changed = true;
+            }
+
+            if (playing)
+            {
+                shown = view;
+                shownCount = player.advance(z, pixels, view);
+            }
+            else if (pixels)
+            {
+                z.stream->advance(z.reverse ? -(int)pixels : pixels);
+            }
+        }
+
+#if GRAYSCALE_BITS > 1
+        if (textLevel != level)
+        {
+            level = textLevel;
+            changed = true;
+        }
+#endif
+
+        if (changed)
+        {
+            Frame &frame = frames[back];
+            for (int r = 0; r < ROWS; r++)
+            {
+                composeRow(frame, r, shown, shownCount, level);
+            }
+
+            // publish it; we get back either the frame that was just replaced on the display, or our
+            // previous frame if the display hadn't picked it up yet
+            frameTimes[back] = t;
+            recordHistogram(renderTimeHist, now() - woke);
+            uint8_t prev = pendingFrame.exchange(back | FRESH_FRAME);
+            back = prev & ~FRESH_FRAME;
+            framesRendered++;
+            if (prev & FRESH_FRAME)
+            {
+                framesDropped++;
+            }
+        }
+    }
+}
+
+// Insert the top n bits of w into a line at column x. Lines need a spare word at the end
+void insertWord(uint32_t *line, int x, uint32_t w, int n)
+{
+    uint32_t mask = n >= 32 ? 0xFFFFFFFF : ~(0xFFFFFFFF >> n);
+    uint32_t *dst = &line[x >> 5];
+    int shift = x & 31;
+    w &= mask;
+
+    dst[0] = (dst[0] & ~(mask >> shift)) | (w >> shift);
+    if (shift)
+    {
+        dst[1] = (dst[1] & ~(mask << (32 - shift))) | (w << (32 - shift));
+    }
+}
+
+// Insert 'count' MSb-first bits from src into a line at column x, a word at a time
+void insertBits(uint32_t *line, int x, const uint8_t *src, int count)
+{
+    int bytes = (count + 7) / 8;
+
+    for (int k = 0; k < count; k += 32)
+    {
+        // next 32 source bits, first bit in the MSb
+        uint32_t w = 0;
+        for (int b = k / 8; b < k / 8 + 4; b++)
+        {
+            w = (w << 8) | (b < bytes ? src[b] : 0);
+        }
+        insertWord(line, x + k, w, min(count - k, 32));
+    }
+}
+
+// Grayscale: split a row of 8 bit pixels, in shift register order, into the bitplanes of row r, with
+// the pixels scaled by level (255 = as drawn)
+void copyPlanes(Frame &frame, int r, const uint8_t *row, uint8_t level)
+{
+    uint8_t bits[GRAYSCALE_BITS] = {};
+
+    for (int c = 0; c < rowBytes * 8; c++)
+    {
+        // scale, and keep the top GRAYSCALE_BITS
+        uint8_t v = (row[c] * (level + 1)) >> (16 - GRAYSCALE_BITS);
+        for (int p = 0; p < GRAYSCALE_BITS; p++)
+        {
+            bits[p] = (bits[p] << 1) | ((v >> p) & 1);
+        }
+
+        if ((c & 7) == 7)
+        {
+            for (int p = 0; p < GRAYSCALE_BITS; p++)
+            {
+                frame.slots[r * GRAYSCALE_BITS + p][c >> 3] = bits[p];
+            }
+        }
+    }
+}
+
+// restart the stream at the beginning of a new message
+void TextStream::begin(const GFXfont *f, const String &s, int windowColumns)
+{
+    font = f;
+    text = s;
+    window = windowColumns;
+    textWidth = getTextWidth(font, text);
+    period = max(window, textWidth);
+    inkLeft = 0;
+    inkRight = 0;
+    for (int g = 0; g <= font->last - font->first; g++)
+    {
+        const GFXglyph &glyph = font->glyph[g];
+        inkLeft = min<int>(inkLeft, glyph.xOffset);
+        inkRight = max<int>(inkRight, glyph.xOffset + glyph.width - glyph.xAdvance);
+    }
+    charIndex = 0;
+    messageCol = 0;
+    backIndex = 0;
+    backCol = 0;
+    frontValid = true;
+    backValid = true;
+    viewStart = 0;
+    renderedFrom = 0;
+    renderedTo = 0;
+    inkFrom = 0;
+    inkTo = 0;
+
+    ring.setFont(font);
+    ring.fillScreen(0);
+#if GRAYSCALE_BITS == 1
+    memset(rows, 0, sizeof(rows));
+    glyphs = GlyphCache::get(font);
+#if BENCHMARK
+    if (!cacheGlyphs)
+    {
+        glyphs = nullptr;
+    }
+#endif
+#endif
+    fill();
+}
+
+// scroll left by some pixels (right if negative), rendering whatever comes into view
+void TextStream::advance(int pixels)
+{
+    viewStart += pixels;
+    if (pixels >= 0)
+    {
+        fill();
+    }
+    else
+    {
+        fillBack();
+    }
+}
 
-// forward refs
-void scrollBitmap(GFXcanvas1 *canvas, bool left);
-void initSPI();
-void transmitSPI(void *data, size_t length);
-int getTextWidth(const GFXfont *f, const String &text);
+// the ring column a stream column is at, which for columns before the start is counted back from the end
+int TextStream::ringColumn(int64_t col)
+{
+    int x = col % RING_COLUMNS;
+    return x < 0 ? x + RING_COLUMNS : x;
+}
 
-// periodic timer wakes our high prio task every 300us to allow for shorter non-blocking delays
-bool IRAM_ATTR onTimer(void *arg)
+// Moves a cursor on over the next piece of the stream, returning its columns: a character, up to
+// limit columns of the gap after the message, or nothing at the end of a repeat
+int TextStream::stepForward(int &index, int &col, int limit) const
 {
-    BaseType_t needToYield = pdFALSE;
-    if (highPrioTaskHandle)
+    int columns = 0;
+    if (index < (int)text.length())
     {
-        vTaskNotifyGiveFromISR(highPrioTaskHandle, &needToYield);
+        char c = text[index++];
+        if (c >= font->first && c <= font->last)
+        {
+            columns = font->glyph[c - font->first].xAdvance;
+        }
     }
+    else if (col < period)
+    {
+        columns = min(period - col, limit);
+    }
+    else
+    {
+        // back to the start of the message
+        index = 0;
+        col = 0;
+    }
+    col += columns;
+    return columns;
+}
 
-    tickCount++;
-
-    return needToYield;
+// the same, back over the piece before the cursor
+int TextStream::stepBack(int &index, int &col, int limit) const
+{
+    int columns = 0;
+    if (col == 0)
+    {
+        // to the end of the previous repeat
+        index = text.length();
+        col = period;
+    }
+    else if (index == (int)text.length() && col > textWidth)
+    {
+        columns = min(col - textWidth, limit);
+    }
+    else
+    {
+        char c = text[--index];
+        if (c >= font->first && c <= font->last)
+        {
+            columns = font->glyph[c - font->first].xAdvance;
+        }
+    }
+    col -= columns;
+    return columns;
 }
 
+// find the front cursor again, from the back one, at the last piece to end in the ring
+void TextStream::findFront()
+{
+    int64_t col = renderedFrom;
+    charIndex = backIndex;
+    messageCol = backCol;
+    while (col < renderedTo)
+    {
+        int index = charIndex;
+        int messageColumn = messageCol;
+        int columns = stepForward(index, messageColumn, renderedTo - col);
+        if (col + columns > renderedTo)
+        {
+            break;
+        }
+        charIndex = index;
+        messageCol = messageColumn;
+        col += columns;
+    }
+    renderedTo = col;
+    frontValid = true;
+}
 
-// waits for a timer trigger tick
-void inline tick(int count = 1)
+// and the back cursor from the front one, at the first piece to start in the ring
+void TextStream::findBack()
 {
-    while (count--)
+    int64_t col = renderedTo;
+    backIndex = charIndex;
+    backCol = messageCol;
+    while (col > renderedFrom)
     {
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int index = backIndex;
+        int messageColumn = backCol;
+        int columns = stepBack(index, messageColumn, col - renderedFrom);
+        if (col - columns < renderedFrom)
+        {
+            break;
+        }
+        backIndex = index;
+        backCol = messageColumn;
+        col -= columns;
     }
+    renderedFrom = col;
+    backValid = true;
 }
 
-// High priority task
-void highPrioTask(void *pvParameters)
+// Render glyphs (or the blank gap after the message) until the visible window is fully populated:
+// up to where the next glyph's ink could reach back to
+void TextStream::fill()
 {
-    std::unique_ptr<GFXcanvas1> canvas(new GFXcanvas1(COLUMNS, ROWS));
-    uint32_t lastScroll = tickCount;
-    
-    for (;;)
+    if (renderedTo + inkLeft - viewStart >= window)
     {
-        if (updateText)
+        return;
+    }
+    if (!frontValid)
+    {
+        findFront();
+    }
+    int64_t from = renderedTo + inkLeft;
+    while (renderedTo + inkLeft - viewStart < window)
+    {
+        int index = charIndex;
+        int columns = stepForward(charIndex, messageCol, window - (renderedTo + inkLeft - viewStart));
+        if (columns)
         {
-            auto fontPtr = &Font5x7Fixed;
-            int w = getTextWidth(fontPtr, text);
-            canvas = std::unique_ptr<GFXcanvas1>(new GFXcanvas1(max(COLUMNS, w), ROWS));
+            if (charIndex != index)
+            {
+                drawGlyph(renderedTo, text[index]);
+            }
+            else
+            {
+                clearTo(renderedTo, renderedTo + columns);
+            }
+        }
+        renderedTo += columns;
+    }
+    from = max(from, inkTo - RING_COLUMNS);     // after a jump of more than the ring, the last of it
+    transposeColumns(from, inkTo - from);
 
-            canvas->setFont(fontPtr);
-            canvas->setTextColor(1);
-            canvas->setCursor(0,7); // font is offset (default font is not)
-            canvas->print(text.c_str());
+    // the back end's columns that have been drawn over, and the glyphs with ink in them
+    if (inkTo - inkFrom > RING_COLUMNS)
+    {
+        inkFrom = inkTo - RING_COLUMNS;
+        if (renderedFrom + inkLeft < inkFrom)
+        {
+            renderedFrom = inkFrom - inkLeft;
+            backValid = false;
+        }
+    }
+}
 
-            updateText = false;
+// the same going back, until the window's left edge is clear of the ink of any glyph still to draw
+void TextStream::fillBack()
+{
+    if (viewStart >= renderedFrom + inkRight)
+    {
+        return;
+    }
+    if (!backValid)
+    {
+        findBack();
+    }
+    int64_t to = renderedFrom + inkRight;
+    while (viewStart < renderedFrom + inkRight)
+    {
+        int index = backIndex;
+        int columns = stepBack(backIndex, backCol, renderedFrom + inkRight - viewStart);
+        renderedFrom -= columns;
+        if (columns)
+        {
+            if (backIndex != index)
+            {
+                drawGlyph(renderedFrom, text[backIndex]);
+            }
+            else
+            {
+                clearTo(renderedFrom, renderedFrom + columns);
+            }
         }
+    }
+    to = min(to, inkFrom + RING_COLUMNS);
+    transposeColumns(inkFrom, to - inkFrom);
 
-        for (int r = 0; r < ROWS; r++)
+    if (inkTo - inkFrom > RING_COLUMNS)
+    {
+        inkTo = inkFrom + RING_COLUMNS;
+        if (renderedTo + inkRight > inkTo)
         {
-            using PinDefs = ScrollingDisplayIntf::PinDefs;
+            renderedTo = inkTo - inkRight;
+            frontValid = false;
+        }
+    }
+}
 
-            // select row
-            digitalWrite(PinDefs::r0, !!(r & 1));
-            digitalWrite(PinDefs::r1, !!(r & 2));
-            digitalWrite(PinDefs::r2, !!(r & 4));
+// draw a glyph with its pen position at stream column pen, ORed over any ink already there
+void TextStream::drawGlyph(int64_t pen, char c)
+{
+    const GFXglyph &glyph = font->glyph[c - font->first];
+    int x = ringColumn(pen);
+#if GRAYSCALE_BITS == 1
+    if (glyphs)
+    {
+        // cached glyphs have all their ink within their advance, so a copy of it is the glyph
+        glyphs->draw(ring.getBuffer(), x, c);
+        inkTo = max(inkTo, pen + glyph.xAdvance);
+        inkFrom = min(inkFrom, pen);
+        return;
+    }
+#endif
+    int left = min<int>(glyph.xOffset, 0);
+    int right = max<int>(glyph.xOffset + glyph.width, glyph.xAdvance);
+    clearTo(pen + left, pen + right);
+    ring.drawChar(x, 7, c, ink, ink, 1);    // font is offset (default font is not)
+    if (x + right > RING_COLUMNS)
+    {
+        ring.drawChar(x - RING_COLUMNS, 7, c, ink, ink, 1); // the part that wrapped around
+    }
+    if (x + left < 0)
+    {
+        ring.drawChar(x + RING_COLUMNS, 7, c, ink, ink, 1);
+    }
+}
 
-            // send the data
-            int16_t w, h;
-            canvas->getSize(w, h);
-            int span = (w + 7) / 8;
-            auto ptr = &canvas->getBuffer()[r * span];
-            size_t count = min((COLUMNS + 7) / 8, span);   // only transfer the bit we can see
-            transmitSPI(ptr, count);
+// take stream columns from..to into the ink range, clearing the ones it didn't have
+void TextStream::clearTo(int64_t from, int64_t to)
+{
+    if (to > inkTo)
+    {
+        int64_t start = max(inkTo, to - RING_COLUMNS);
+        clearColumns(ringColumn(start), to - start);
+        inkTo = to;
+    }
+    if (from < inkFrom)
+    {
+        int64_t end = min(inkFrom, from + RING_COLUMNS);
+        clearColumns(ringColumn(from), end - from);
+        inkFrom = from;
+    }
+}
 
-            tick(TICKS_PER_TRANSACTION);    // SPI will transfer in this time
+// clear some columns of the ring, from ring column x
+void TextStream::clearColumns(int x, int count)
+{
+#if GRAYSCALE_BITS == 1
+    // a byte per column
+    int n = min(count, RING_COLUMNS - x);
+    memset(&ring.getBuffer()[x], 0, n);
+    memset(ring.getBuffer(), 0, count - n);
+#else
+    ring.fillRect(x, 0, count, ROWS, 0);
+    if (x + count > RING_COLUMNS)
+    {
+        ring.fillRect(x - RING_COLUMNS, 0, count, ROWS, 0);
+    }
+#endif
+}
 
-            digitalWrite(PinDefs::oe, LOW);     // LEDs on
-            tick();
-            digitalWrite(PinDefs::oe, HIGH);     // LEDs off
+#if GRAYSCALE_BITS == 1
+// the cache for a font, loading it if there's room
+const GlyphCache *GlyphCache::get(const GFXfont *f)
+{
+    static GlyphCache caches[GLYPH_CACHE_FONTS];
+    static const GFXfont *refused[GLYPH_CACHE_REFUSED];  // most recent first
+    for (const GFXfont *r : refused)
+    {
+        if (r == f)
+        {
+            return nullptr;
         }
-
-        // delay for the rest of the frame
-        tick(TICKS_PER_FRAME - ROWS * (TICKS_PER_TRANSACTION + 1));
-
-        // scroll needed?
-        if ((tickCount - lastScroll) * TIMER_INTERVAL_US > scrollDelay * 1000)
+    }
+    for (GlyphCache &cache : caches)
+    {
+        if (cache.font == f)
+        {
+            return &cache;
+        }
+        if (!cache.font)
         {
-            lastScroll += scrollDelay * 1000 / TIMER_INTERVAL_US;  // constant scrolling timebase
-            scrollBitmap(canvas.get(), true);
+            if (cache.load(f))
+            {
+                return &cache;
+            }
+
+            // the slot stays free for a font that fits
+            memmove(&refused[1], &refused[0], sizeof(refused) - sizeof(refused[0]));
+            refused[0] = f;
+            return nullptr;
         }
     }
+    return nullptr;
 }
 
-// scroll the bitmap one pixel, left or right, wrapping around
-void scrollBitmap(GFXcanvas1 *canvas, bool left)
+// render every glyph of the font into columns, as drawChar() would draw it at row 7
+bool GlyphCache::load(const GFXfont *f)
 {
-    int16_t width, height;
-    canvas->getSize(width, height);
-
-    uint8_t *buffer = canvas->getBuffer();
+    if (f->last - f->first >= 256)
+    {
+        return false;
+    }
 
-    for (int y = 0; y < height; y++)
+    int used = 0;
+    for (int g = 0; g <= f->last - f->first; g++)
     {
-        // data is stored MSb-first
-        int blocks = (width + 7) / 8;       // 8 bit blocks
-        uint8_t *ptr = &buffer[y * blocks]; // row ptr
+        const GFXglyph &glyph = f->glyph[g];
+        if (glyph.xOffset < 0 || glyph.xOffset + glyph.width > glyph.xAdvance ||
+            used + glyph.xAdvance > GLYPH_CACHE_COLUMNS)
+        {
+            return false;
+        }
+        start[g] = used;
+        memset(&columns[used], 0, glyph.xAdvance);
 
-        bool bit = left ? (ptr[0] & 0x80) : (ptr[blocks - 1] & 0x01);
-        for (int xb = 0; xb < blocks; xb++)
+        // glyph bitmaps are rows of bits, MSb first, packed with no padding
+        const uint8_t *bitmap = &f->bitmap[glyph.bitmapOffset];
+        int bit = 0;
+        for (int yy = 0; yy < glyph.height; yy++)
         {
-            if (left)
+            for (int xx = 0; xx < glyph.width; xx++, bit++)
             {
-                uint8_t *p = &ptr[blocks - xb - 1]; // reverse
-                bool temp = *p & 0x80;
-                *p = (*p << 1) | bit;
-                bit = temp;
-            }
-            else
-            {
-                uint8_t *p = &ptr[xb];
-                bool temp = *p & 1;
-                *p = (*p >> 1) | (bit << 7);
-                bit = temp;
+                int r = 7 + glyph.yOffset + yy;
+                if ((bitmap[bit >> 3] << (bit & 7)) & 0x80 && r >= 0 && r < ROWS)
+                {
+                    columns[used + glyph.xOffset + xx] |= 1 << r;
+                }
             }
         }
+        used += glyph.xAdvance;
     }
+    font = f;
+    return true;
 }
 
+// Draw glyph c into a ring of column bytes with its pen position at column x. The columns of its
+// advance are replaced, which clears them as well
+void GlyphCache::draw(uint8_t *ring, int x, int c) const
+{
+    int g = c - font->first;
+    const uint8_t *src = &columns[start[g]];
+    int adv = font->glyph[g].xAdvance;
+    int n = min(adv, RING_COLUMNS - x);
+    memcpy(&ring[x], src, n);
+    memcpy(ring, &src[n], adv - n);     // the part that wrapped around
+}
+#endif
 
-void transmitSPI(void *data, size_t length) {
-    constexpr size_t buffSize = (COLUMNS + 7) / 8;
-    if (length > buffSize)
+// Bring the rows up to date with the columns rendered from stream column col, 8 columns at a time. The
+// rows are only read a word at a time (a glyph is drawn once, but shown in every frame it's in view),
+// so that's the layout they're kept in; the columns make drawing and clearing glyphs cheap
+void TextStream::transposeColumns(int64_t col, int count)
+{
+#if GRAYSCALE_BITS == 1
+    int x = ringColumn(col) / 8;
+    int groups = (ringColumn(col) % 8 + count + 7) / 8;
+    for (int g = 0; g < groups; g++)
     {
-        length = buffSize;
+        uint8_t bytes[8];
+        GFXcanvasColumns::transpose8(&ring.getBuffer()[x * 8], bytes);
+        for (int r = 0; r < ROWS; r++)
+        {
+            rows[r][x] = bytes[r];
+        }
+        if (++x == RING_COLUMNS / 8)
+        {
+            x = 0;
+        }
     }
+#endif
+}
 
-    if (!dmaBuff)
+#if !SCAN_IN_ISR
+// queue slot s of a frame; the data is sent straight from the frame buffer
+void transmitSlot(uint8_t frame, int s) {
+    if (spi)
     {
-        dmaBuff = heap_caps_malloc(buffSize, MALLOC_CAP_DMA);
+        waitSPI();  // purge
+
+        spiStartTime = esp_timer_get_time();
+        TRACE_EVENT(TraceEvent::SpiQueue);
+        esp_err_t ret = spi_device_queue_trans(spi, &slotTrans[frame][s], 0);
+        if (ret != ESP_OK) {
+            spiQueueFailures++;     // queue full; the row is skipped
+        } else {
+            spiPending = true;
+        }
     }
+}
 
-    if (dmaBuff)
+// SPI post-transaction callback (ISR context): timestamp the completion
+void IRAM_ATTR onSPIDone(spi_transaction_t *trans)
+{
+    spiDoneTime = esp_timer_get_time();
+    TRACE_EVENT(TraceEvent::SpiDone);
+}
+
+// blocks until the last queued transfer has completed, and records how long it took
+void waitSPI()
+{
+    if (spiPending)
     {
         spi_transaction_t *result;
-        spi_device_get_trans_result(spi, &result, 0);   // purge
-
-        memset(&spiTrans, 0, sizeof(spiTrans));
-        spiTrans.length = length * 8;     // bits
-        spiTrans.tx_buffer = dmaBuff;
-        memcpy(dmaBuff, data, length);
-
-        esp_err_t ret = spi_device_queue_trans(spi, &spiTrans, 0);
-        if (ret != ESP_OK) {
-            // queue full, handle if needed
+        if (spi_device_get_trans_result(spi, &result, portMAX_DELAY) == ESP_OK)
+        {
+            uint32_t us = spiDoneTime - spiStartTime;
+            spiTransferUs = us;
+            if (us > spiTransferMaxUs)
+            {
+                spiTransferMaxUs = us;
+            }
         }
+        spiPending = false;
     }
 }
+#endif
 
 void initSPI() {
     using PinDefs = ScrollingDisplayIntf::PinDefs;
@@ -213,11 +1764,73 @@ void initSPI() {
     spi_device_interface_config_t devcfg = {};
     devcfg.clock_speed_hz = SPI_SPEED;
     devcfg.mode = 0;
+#if SCAN_PIPELINED
+    devcfg.spics_io_num = -1;   // CS is the panel latch, which we drive ourselves
+#else
     devcfg.spics_io_num = PinDefs::cs;
+#endif
     devcfg.queue_size = 1;  // only single transaction ever
 
+#if SCAN_IN_ISR
+    // The scan ISR writes rows straight into the peripheral's data buffer, as the driver's queue
+    // can't be used from an ISR. Run one blank row through the driver so it configures the
+    // peripheral for us, then keep the bus to ourselves
+    spi_bus_initialize(SPI_HOST, &buscfg, SPI_DMA_DISABLED);
+    spi_bus_add_device(SPI_HOST, &devcfg, &spi);
+    spi_device_acquire_bus(spi, portMAX_DELAY);
+
+    spi_transaction_t blank = {};
+    blank.length = rowBytes * 8;   // bits
+    blank.tx_buffer = frames[0].slots[0];
+    spi_device_polling_transmit(spi, &blank);
+    spiHw = SPI_LL_GET_HW(SPI_HOST);
+    rowTransferUs = (rowBytes * 8 * 1000000UL + SPI_SPEED - 1) / SPI_SPEED;
+#else
+    devcfg.post_cb = onSPIDone;
+
     spi_bus_initialize(SPI_HOST, &buscfg, SPI_DMA_CH_AUTO);
     spi_bus_add_device(SPI_HOST, &devcfg, &spi);
+
+    // the transactions never change, only the frame contents do
+    for (int f = 0; f < 3; f++)
+    {
+        for (int s = 0; s < SLOTS; s++)
+        {
+            slotTrans[f][s] = {};
+            slotTrans[f][s].length = rowBytes * 8;    // bits
+            slotTrans[f][s].tx_buffer = frames[f].slots[s];
+        }
+    }
+#endif
+}
+
+// work out the display width, row length and remap runs from the geometry
+void buildRemap()
+{
+    const ScrollingDisplayIntf::Geometry &g = geometry;
+    columns = g.modules * g.moduleColumns;
+    rowBytes = (g.modules * g.registerBits + 7) / 8;
+
+    remapRunCount = 0;
+    for (int m = 0; m < g.modules; m++)
+    {
+        RemapRun run;
+        run.src = m * g.moduleColumns;
+        run.dst = (g.reverseChain ? g.modules - 1 - m : m) * g.registerBits;
+        run.count = g.moduleColumns;
+        run.mirrored = (g.mirrored >> m) & 1;
+
+        RemapRun *last = remapRunCount ? &remapRuns[remapRunCount - 1] : nullptr;
+        if (last && !last->mirrored && !run.mirrored && last->src + last->count == run.src &&
+            last->dst + last->count == run.dst)
+        {
+            last->count += run.count;   // carries straight on from the last one
+        }
+        else
+        {
+            remapRuns[remapRunCount++] = run;
+        }
+    }
 }
 
 // text helper:
@@ -251,7 +1864,11 @@ void ScrollingDisplayIntf::begin()
     {
         // init pins
         pinMode(PinDefs::cs, OUTPUT);
+#if SCAN_PIPELINED
+        digitalWrite(PinDefs::cs, LOW); // Latch idles low, pulsed high at each row boundary
+#else
         digitalWrite(PinDefs::cs, HIGH); // Deselect slave
+#endif
 
         pinMode(PinDefs::oe, OUTPUT);
         digitalWrite(PinDefs::oe, HIGH);
@@ -263,34 +1880,55 @@ void ScrollingDisplayIntf::begin()
         pinMode(PinDefs::r2, OUTPUT);
         digitalWrite(PinDefs::r2, LOW);
 
-        // init the SPI for non-blocking DMA transfers
-        initSPI();
+        // size everything for the panel
+        buildRemap();
 
-        // Create high priority task (stack 32kB, prio 23)
-        xTaskCreate(
-            highPrioTask,
-            "HighPrioTask",
-            32 * 1024, // 32 KB stack
-            nullptr,
-            25, // priority
-            &highPrioTaskHandle
-        );
+        // init the SPI for non-blocking transfers
+        initSPI();
 
-        // Start timer to periodically wake up the task
+        // Start the free-running timebase; the tasks use it from the start, so this comes first.
+        // The alarm is armed as needed to wake the high priority task (or to run the next scan step)
         timer_config_t config = {
-            .alarm_en = TIMER_ALARM_EN,
+            .alarm_en = TIMER_ALARM_DIS,
             .counter_en = TIMER_PAUSE,
             .intr_type = TIMER_INTR_LEVEL,
             .counter_dir = TIMER_COUNT_UP,
-            .auto_reload = TIMER_AUTORELOAD_EN,
+            .auto_reload = TIMER_AUTORELOAD_DIS,
             .divider = TIMER_DIVIDER};
         timer_init(TIMER_GROUP, TIMER_IDX, &config);
         timer_set_counter_value(TIMER_GROUP, TIMER_IDX, 0);
-        timer_set_alarm_value(TIMER_GROUP, TIMER_IDX, TIMER_INTERVAL_US);
         timer_enable_intr(TIMER_GROUP, TIMER_IDX);
         timer_isr_callback_add(TIMER_GROUP, TIMER_IDX, onTimer, nullptr, 0);
         timer_start(TIMER_GROUP, TIMER_IDX);
 
+        // Create render task first, as the high priority task wakes it every frame. Lower priority
+        // than Wi-Fi, as a late frame only delays a scroll step
+        xTaskCreate(
+            renderTask,
+            "RenderTask",
+            8 * 1024, // 8 KB stack
+            nullptr,
+            10, // priority
+            &renderTaskHandle
+        );
+
+#if SCAN_IN_ISR
+        // the scan runs in the timer ISR; start it a frame from now
+        scanFrameStart = scanDue = now() + FRAME_US;
+        timer_set_alarm_value(TIMER_GROUP, TIMER_IDX, scanDue);
+        timer_set_alarm(TIMER_GROUP, TIMER_IDX, TIMER_ALARM_EN);
+#else
+        // Create high priority task (stack 32kB, prio 23)
+        xTaskCreate(
+            highPrioTask,
+            "HighPrioTask",
+            32 * 1024, // 32 KB stack
+            nullptr,
+            25, // priority
+            &highPrioTaskHandle
+        );
+#endif
+
         begun = true;
     }
 }
@@ -312,10 +1950,238 @@ void ScrollingDisplayIntf::setText(const String &s)
     }
 }
 
+void ScrollingDisplayIntf::setGeometry(const Geometry &g)
+{
+    geometry.modules = constrain(g.modules, 1, MAX_MODULES);
+    geometry.registerBits = constrain(g.registerBits, 1, MAX_REGISTER_BITS);
+    geometry.moduleColumns = constrain(g.moduleColumns, 1, geometry.registerBits);
+    geometry.reverseChain = g.reverseChain;
+    geometry.mirrored = g.mirrored;
+}
+
+int ScrollingDisplayIntf::getColumns() const
+{
+    return geometry.modules * geometry.moduleColumns;
+}
+
+void ScrollingDisplayIntf::setZones(const Zone *zones, int count)
+{
+    if (!updateZones)
+    {
+        int n = 0;
+        for (int i = 0; i < count && n < MaxZones; i++)
+        {
+            // keep zones on the display
+            Zone zone = zones[i];
+            zone.x = constrain(zone.x, 0, columns - 1);
+            zone.width = min(zone.width, columns - zone.x);
+            if (zone.width <= 0)
+            {
+                continue;
+            }
+            if (zone.text.length() > MaxTextLength)
+            {
+                zone.text = zone.text.substring(0, MaxTextLength);
+            }
+            zoneConfig[n++] = zone;
+        }
+        zoneCount = n;
+
+        updateZones = true;
+    }
+}
+
+void ScrollingDisplayIntf::setPlaylist(const PlaylistItem *items, int count)
+{
+    if (!updatePlaylist)
+    {
+        int n = constrain(count, 0, MaxPlaylistItems);
+        for (int i = 0; i < n; i++)
+        {
+            playlistConfig[i] = items[i];
+            if (items[i].text.length() > MaxTextLength)
+            {
+                playlistConfig[i].text = items[i].text.substring(0, MaxTextLength);
+            }
+        }
+        playlistCount = n;
+
+        updatePlaylist = true;
+    }
+}
+
 void ScrollingDisplayIntf::setScrollDelay(int pixelShiftDelayMillis)
 {
-    scrollDelay = pixelShiftDelayMillis;
+    setScrollSpeed(1000000 / max(pixelShiftDelayMillis, 1));
+}
+
+void ScrollingDisplayIntf::setScrollSpeed(uint32_t milliPixelsPerSecond)
+{
+    scrollSpeed = milliPixelsPerSecond;
+}
+
+void ScrollingDisplayIntf::setTextLevel(uint8_t level)
+{
+    textLevel = level;
+}
+
+void ScrollingDisplayIntf::setBrightness(uint8_t level)
+{
+    brightness = level;
+}
+
+ScrollingDisplayIntf::Stats ScrollingDisplayIntf::getStats() const
+{
+    Stats stats;
+    stats.spiTransferUs = spiTransferUs;
+    stats.spiTransferMaxUs = spiTransferMaxUs;
+    stats.timerInterrupts = timerInterrupts;
+    stats.wakeLatencyAvgUs = wakeLatencyAvgUs;
+    stats.wakeLatencyMaxUs = wakeLatencyMaxUs;
+    return stats;
+}
+
+void ScrollingDisplayIntf::getMetrics(Metrics &m) const
+{
+    portENTER_CRITICAL(&metricsLock);
+    m.wakeLatency = wakeLatencyHist;
+    m.slotOverrun = slotOverrunHist;
+    m.framePeriod = framePeriodHist;
+    m.scrollLag = scrollLagHist;
+    m.renderTime = renderTimeHist;
+    portEXIT_CRITICAL(&metricsLock);
+    m.frames = frameCount;
+    m.framesLate = framesLate;
+    m.framesRendered = framesRendered;
+    m.framesDropped = framesDropped;
+    m.spiQueueFailures = spiQueueFailures;
+}
+
+#if BENCHMARK
+// The render task's kernels, on the panel as set by setGeometry(): starting a message, a scroll step
+// (the stream advancing, then every row composed into a frame) and measuring text
+void benchmarkDisplay(BenchReporter &bench)
+{
+    static TextStream stream;
+    static Frame frame;
+    char name[64];
+
+    buildRemap();
+    ZoneState zone;
+    zone.width = columns;
+    zone.stream = &stream;
+
+#if GRAYSCALE_BITS == 1
+    // a glyph from the cache, against drawChar/5x7/columns
+    const GlyphCache *glyphs = GlyphCache::get(&Font5x7Fixed);
+    static uint8_t ring[RING_COLUMNS];
+    bench.run("drawGlyph/cached", [&](uint32_t n)
+              {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            glyphs->draw(ring, benchGlyphX(i, RING_COLUMNS), 'A' + i % 58);
+        } });
+#endif
+
+    static const int lengths[] = {16, 256, 4096};
+    for (int len : lengths)
+    {
+        String text = benchMessage(len);
+        volatile int width = 0;
+        snprintf(name, sizeof(name), "getTextWidth/%d", len);
+        bench.run(name, [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                width = getTextWidth(&Font5x7Fixed, text);
+            } });
+
+        snprintf(name, sizeof(name), "stream.begin/%d", len);
+        bench.run(name, [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                stream.begin(&Font5x7Fixed, text, columns);
+            } });
+
+        // the whole message, a window at a time
+        snprintf(name, sizeof(name), "stream.render/%d", len);
+        bench.run(name, [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                stream.begin(&Font5x7Fixed, text, columns);
+                while ((int)stream.position() < stream.length())
+                {
+                    stream.advance(columns);
+                }
+            } });
+    }
+
+#if GRAYSCALE_BITS == 1
+    // the same without the glyph cache, drawing with drawChar() as before it, for the cache's gain
+    String text = benchMessage(4096);
+    stream.cacheGlyphs = false;
+    bench.run("stream.render/4096/uncached", [&](uint32_t n)
+              {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            stream.begin(&Font5x7Fixed, text, columns);
+            while ((int)stream.position() < stream.length())
+            {
+                stream.advance(columns);
+            }
+        } });
+    stream.cacheGlyphs = true;
+#endif
+
+    stream.begin(&Font5x7Fixed, benchMessage(256), columns);
+    bench.run("composeFrame", [&](uint32_t n)
+              {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            for (int r = 0; r < ROWS; r++)
+            {
+                composeRow(frame, r, &zone, 1, 255);
+            }
+        } });
+
+    // a pixel across message lengths, against scroll/bitmap/N: the cost is the display's width,
+    // whatever the message's
+    for (int len : scrollLengths)
+    {
+        stream.begin(&Font5x7Fixed, benchMessage(len), columns);
+        snprintf(name, sizeof(name), "scroll/viewport/%d", len);
+        bench.run(name, [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                stream.advance(1);
+                for (int r = 0; r < ROWS; r++)
+                {
+                    composeRow(frame, r, &zone, 1, 255);
+                }
+            } });
+    }
+
+    stream.begin(&Font5x7Fixed, benchMessage(256), columns);
+    static const int steps[] = {1, 8, -1, -8};   // negative: scrolling right
+    for (int pixels : steps)
+    {
+        snprintf(name, sizeof(name), "scroll/%dpx", pixels);
+        bench.run(name, [&](uint32_t n)
+                  {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                stream.advance(pixels);
+                for (int r = 0; r < ROWS; r++)
+                {
+                    composeRow(frame, r, &zone, 1, 255);
+                }
+            } });
+    }
 }
+#endif // BENCHMARK
 
 // instance for the app to use
-ScrollingDisplayIntf ScrollingDisplay;
\ No newline at end of file
+ScrollingDisplayIntf ScrollingDisplay;
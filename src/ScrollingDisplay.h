@@ -2,13 +2,106 @@
 #define __ScrollingDisplay_h__
 
 #include <Arduino.h>
+#include "gfxfont.h"
 
 class ScrollingDisplayIntf
 {
 public:
+    // Panel geometry. Modules are numbered left to right. Each takes registerBits of the row shifted
+    // out, in chain order, with its LED columns in the first moduleColumns of them
+    struct Geometry
+    {
+        int modules = 7;            // was 8 display modules, but ones been removed
+        int moduleColumns = 60;     // LED columns per module
+        int registerBits = 60;      // bits shifted out per module; the boards have 64 outputs, but
+                                    // they've always been sent as a contiguous stream of 60
+        bool reverseChain = false;  // first module in the chain is the rightmost
+        uint8_t mirrored = 0;       // bit m set: module m's columns are wired right to left
+    };
+    void setGeometry(const Geometry &g);    // before begin(); up to 8 modules of 64 bits
+    int getColumns() const;
+
     void begin();
     void setText(const String &s);
-    void setScrollDelay(int pixelShiftDelayMillis);
+    void setScrollDelay(int pixelShiftDelayMillis);         // delay per pixel, 1 ms or more
+    void setScrollSpeed(uint32_t milliPixelsPerSecond);     // same thing, as a speed
+    void setBrightness(uint8_t level);  // overall brightness 0 (off) .. 255 (full OE time)
+    void setTextLevel(uint8_t level);   // text brightness 0..255; only has an effect with GRAYSCALE_BITS > 1
+
+    // Layout. By default the whole display is one zone showing setText() at the scroll speed; it can
+    // instead be split into zones, each with its own text, font, speed and alignment
+    enum class Align : uint8_t
+    {
+        Left,
+        Center,
+        Right
+    };
+    struct Zone
+    {
+        int x = 0;                          // first column
+        int width = 0;                      // columns
+        String text;
+        const GFXfont *font = nullptr;      // nullptr for the default font
+        uint32_t milliPixelsPerSecond = 0;  // scroll speed; 0 for static text, which is only drawn once
+        Align align = Align::Left;          // placement of static text within the zone
+        bool reverse = false;               // scroll right, so the text comes in from the left
+    };
+    static constexpr int MaxZones = 4;
+    void setZones(const Zone *zones, int count);   // scrolling zones draw over static ones; 0 zones reverts to setText()
+
+    // Playlist, shown in place of setText() when there's no zone layout. Each item scrolls past 'dwell'
+    // times, then the next one comes in with its transition
+    enum class Transition : uint8_t
+    {
+        Cut,    // replace the view at once
+        Push,   // the next item scrolls in behind the current one
+        Wipe,   // the next item is uncovered from the left, at the scroll speed
+    };
+    struct PlaylistItem
+    {
+        String text;
+        uint32_t milliPixelsPerSecond = 0;  // 0 for the display's scroll speed
+        uint16_t dwell = 1;                 // passes before moving on
+        Transition transition = Transition::Cut;
+    };
+    static constexpr int MaxPlaylistItems = 16;
+    void setPlaylist(const PlaylistItem *items, int count);    // 0 items reverts to setText()
+
+    // display driver statistics
+    struct Stats
+    {
+        uint32_t spiTransferUs;     // time taken to shift out the last row
+        uint32_t spiTransferMaxUs;  // longest row shift since boot
+        uint32_t timerInterrupts;   // scan timer interrupts since boot
+        uint32_t wakeLatencyAvgUs;  // how late the scan runs after its timer alarm (average)
+        uint32_t wakeLatencyMaxUs;  // and the worst case since boot
+    };
+    Stats getStats() const;
+
+    // Timing histograms, in µs. counts[i] is the number of values up to bounds[i] (not cumulative),
+    // and counts[Buckets] the number above the last bound
+    struct Histogram
+    {
+        static constexpr int Buckets = 10;
+        uint32_t bounds[Buckets];
+        uint32_t counts[Buckets + 1];
+        uint32_t count;
+        uint64_t sum;
+    };
+    struct Metrics
+    {
+        Histogram wakeLatency;      // how late the scan ran after its timer alarm
+        Histogram slotOverrun;      // how far a scan slot ran past its time (only slots that did)
+        Histogram framePeriod;      // time between frame starts
+        Histogram scrollLag;        // from the render task taking the scroll position to the frame being shown
+        Histogram renderTime;       // from the render task waking to publishing its frame
+        uint32_t frames;            // frames scanned
+        uint32_t framesLate;        // frames that started more than a frame late
+        uint32_t framesRendered;
+        uint32_t framesDropped;     // rendered, but replaced before the display picked them up
+        uint32_t spiQueueFailures;  // rows that couldn't be queued to the SPI driver
+    };
+    void getMetrics(Metrics &m) const;
 
     // IO definitions
     struct PinDefs
@@ -0,0 +1,135 @@
+#include "Trace.h"
+
+#if EVENT_TRACE
+
+#include "esp_attr.h"
+#include "esp_timer.h"
+
+#include <atomic>
+
+struct TraceEntry
+{
+    uint32_t time;
+    TraceEvent event;
+    uint16_t arg;
+};
+
+// Writers claim a slot with one atomic increment, so the scan ISR, the display tasks and the loop
+// can all record without locks. A writer preempted between claiming and filling its slot leaves it
+// stale until it resumes, which at worst misplaces one event in a trace read out at that moment
+static TraceEntry traceRing[TRACE_RING_EVENTS];
+static std::atomic<uint32_t> traceHead(0);      // events recorded, ever
+static std::atomic<bool> tracePaused(false);
+
+// timeline (tid) each event is shown on
+enum TraceThread : uint8_t
+{
+    Scan = 1,
+    Render,
+    Spi,
+    Http,
+    WiFi,
+};
+
+struct TraceEventInfo
+{
+    const char *name;
+    char phase;             // Chrome trace phase: B(egin), E(nd) or i(nstant)
+    uint8_t thread;
+    const char *argName;    // nullptr if the arg isn't shown
+};
+
+static const TraceEventInfo eventInfo[] = {
+    {"timer", 'i', Scan, nullptr},      // TimerIsr
+    {"wake", 'i', Scan, nullptr},       // TaskWake (moved to Render by its arg)
+    {"frame", 'i', Scan, nullptr},      // Frame
+    {"row", 'i', Scan, "row"},          // RowSelect
+    {"spi", 'B', Spi, nullptr},         // SpiQueue
+    {"spi", 'E', Spi, nullptr},         // SpiDone
+    {"oe", 'B', Scan, "slot"},          // OeOn
+    {"oe", 'E', Scan, nullptr},         // OeOff
+    {"text", 'i', Render, nullptr},     // TextSwap
+    {"http", 'B', Http, nullptr},       // HttpBegin
+    {"http", 'E', Http, nullptr},       // HttpEnd
+    {"wifi", 'i', WiFi, "event"},       // WiFi
+};
+static_assert(sizeof(eventInfo) / sizeof(eventInfo[0]) == (int)TraceEvent::WiFi + 1, "an entry for every event");
+
+uint32_t IRAM_ATTR traceTime()
+{
+    return esp_timer_get_time();
+}
+
+void IRAM_ATTR traceEvent(TraceEvent e, uint16_t arg)
+{
+    traceEventAt(e, traceTime(), arg);
+}
+
+void IRAM_ATTR traceEventAt(TraceEvent e, uint32_t time, uint16_t arg)
+{
+    if (tracePaused)
+    {
+        return;
+    }
+
+    TraceEntry &entry = traceRing[traceHead++ % TRACE_RING_EVENTS];
+    entry.time = time;
+    entry.event = e;
+    entry.arg = arg;
+}
+
+void traceWriteJson(TraceWriter write)
+{
+    tracePaused = true;
+    uint32_t head = traceHead;
+    uint32_t first = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+    uint32_t start = traceRing[first % TRACE_RING_EVENTS].time;
+
+    String chunk = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    static const char *threadNames[] = {"", "scan", "render", "spi", "http", "wifi"};
+    char buf[128];
+    for (int t = Scan; t <= WiFi; t++)
+    {
+        snprintf(buf, sizeof(buf), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                 t == Scan ? "" : ",", t, threadNames[t]);
+        chunk += buf;
+    }
+
+    for (uint32_t i = first; i < head; i++)
+    {
+        const TraceEntry &entry = traceRing[i % TRACE_RING_EVENTS];
+        if ((uint8_t)entry.event > (uint8_t)TraceEvent::WiFi)
+        {
+            continue;
+        }
+        const TraceEventInfo &info = eventInfo[(int)entry.event];
+        int thread = entry.event == TraceEvent::TaskWake && entry.arg ? Render : info.thread;
+
+        // times are relative to the oldest event, which also takes care of the 32 bit wrap
+        int n = snprintf(buf, sizeof(buf), ",{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%d%s",
+                         info.name, info.phase, (unsigned long)(entry.time - start), thread,
+                         info.phase == 'i' ? ",\"s\":\"t\"" : "");
+        if (info.argName)
+        {
+            snprintf(buf + n, sizeof(buf) - n, ",\"args\":{\"%s\":%u}}", info.argName, entry.arg);
+        }
+        else
+        {
+            snprintf(buf + n, sizeof(buf) - n, "}");
+        }
+        chunk += buf;
+
+        if (chunk.length() > 1024)
+        {
+            write(chunk);
+            chunk = "";
+        }
+    }
+    chunk += "]}";
+    write(chunk);
+
+    traceHead = 0;
+    tracePaused = false;
+}
+
+#endif // EVENT_TRACE
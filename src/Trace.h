@@ -0,0 +1,47 @@
+#ifndef __Trace_h__
+#define __Trace_h__
+
+#include <Arduino.h>
+
+// Event trace, for lining up the display scan against Wi-Fi and web server activity. Build with
+// -D EVENT_TRACE=1 to enable it; otherwise TRACE_EVENT() compiles to nothing. Events go into a fixed
+// size ring, oldest overwritten first, and can be read out as Chrome trace JSON (chrome://tracing,
+// or ui.perfetto.dev)
+#ifndef EVENT_TRACE
+#define EVENT_TRACE 0
+#endif
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS 4096  // 8 bytes each; about 1.5s of scan at 60 FPS
+#endif
+
+enum class TraceEvent : uint8_t
+{
+    TimerIsr,   // scan timer interrupt
+    TaskWake,   // a display task woke; arg 0 for the scan, 1 for the render task
+    Frame,      // the scan started a frame
+    RowSelect,  // arg is the row
+    SpiQueue,   // row queued (or kicked) to SPI
+    SpiDone,    // row shifted out
+    OeOn,       // LEDs on; arg is the scan slot
+    OeOff,
+    TextSwap,   // the render task took new text, zones or playlist
+    HttpBegin,  // the web server handling a request
+    HttpEnd,
+    WiFi,       // Wi-Fi event; arg is the arduino_event_id_t
+};
+
+#if EVENT_TRACE
+#define TRACE_EVENT(...) traceEvent(__VA_ARGS__)
+#else
+#define TRACE_EVENT(...)
+#endif
+
+uint32_t traceTime();   // the trace timebase, µs
+void traceEvent(TraceEvent e, uint16_t arg = 0);
+void traceEventAt(TraceEvent e, uint32_t time, uint16_t arg = 0);
+
+// Writes out the ring as Chrome trace JSON, in chunks, then clears it. Recording is paused meanwhile
+typedef void (*TraceWriter)(const String &chunk);
+void traceWriteJson(TraceWriter write);
+
+#endif // __Trace_h__
@@ -1,6 +1,6 @@
 /*
 Side scrolling LED matrix display ("subway sign")
-7 rows x 60 cols x 7 modules (was 8 modules, but one's been removed)
+7 rows x 60 cols x 7 modules by default (was 8 modules, but one's been removed); see /setgeometry
 
 Connector pinout:
 1 - 5V      - 5V supply from the display boards
@@ -9,7 +9,7 @@ Connector pinout:
 4 - R0      - row select bit 0
 5 - R1      - row select bit 1
 6 - R2      - row select bit 2
-7 - /OE     - output enable (drive LEDs) - uses 300us ON per row per frame
+7 - /OE     - output enable (drive LEDs) - ON for what each row's share of the frame leaves after the shift
 9 - data    - data to go in the shift register
 10 - GND    - common ground / 0V
 
@@ -24,13 +24,17 @@ This program:
 - can configure via http at scrollingdisplay.local (either AP or STA modes), or via 192.168.0.1 for AP mode.
 
 technical:
-- use a 300us timer interrupt as the timebase for all output, wake hi prio task
+- use a free-running timer as the timebase for all output; one-shot alarms wake the hi prio task for each OE edge/frame start
     - hi prio task manages:
+        - control signals and queuing SPI transfers, from the latest rendered frame
+    - render task (woken once per frame) manages:
         - updating the bitmap to be displayed, and
             - use adafruit graphics library for drawing to the bitmap
-        - control signals and queuing SPI transfers
+        - publishing each new frame to the hi prio task (triple buffered, no allocation in the hi prio task)
+    - brightness shortens the OE pulse within each row slot, so it doesn't change the refresh or scroll timing
 - low prio task does the logic for the network, and forwards changes of the string to the high prio task
     - web interface have index.html for setting the displayed text and scroll rate, as well as connection SSIDs and passwords, and OTA firmware/filesystem updates
+    - applies the brightness schedule (time of day from NTP, once connected to the LAN)
 */
 
 // #define DEBUG // << enable serial print statements
@@ -45,6 +49,8 @@ technical:
 #include <ArduinoJson.h>
 
 #include "ScrollingDisplay.h"
+#include "Trace.h"
+#include "Benchmark.h"
 
 #define LED_PIN 8
 
@@ -64,22 +70,34 @@ String apPass = "12345678";
 String mdnsHostName = "scrollingdisplay";
 String text;
 int scrollDelay = 50;
+int brightness = 255;               // used when there's no schedule, or the time isn't known yet
+String brightnessSchedule;          // "HH:MM=level,HH:MM=level,..." (local time, level 0..255)
+String timezone = "UTC0";           // POSIX TZ string, for the schedule
+ScrollingDisplayIntf::Geometry geometry;    // panel layout; only read at boot
 
 #define WIFI_RECONNECT_INTERVAL 60000 // 1 min
 #define AP_TIMEOUT (5 * 60 * 1000)    // AP will close 5 minutes after boot
+#define NTP_SERVER "pool.ntp.org"
+#define BRIGHTNESS_CHECK_INTERVAL 10000 // check the schedule every 10s
+#define TRACE_HTTP_MIN_US 200           // handleClient() calls shorter than this didn't serve anything
 
 WebServer server(80);
 IPAddress apIP(192, 168, 0, 1);
 
 void setupWiFi();
 void handleWiFiConnection();
+void applyBrightness();
 
 bool saveSettings();
 bool loadSettings();
+bool applyPlaylist(const String &json);
+bool loadPlaylist();
 
 // Files we use
 #define INDEX_HTML_FILENAME "/web/index.html"
 #define SETTINGS_FILENAME "/message.txt"
+#define PLAYLIST_FILENAME "/playlist.json"
+#define BENCH_BASELINE_FILENAME "/bench_baseline.jsonl"    // an earlier benchmark report, to compare against
 
 String systemInfo()
 {
@@ -100,6 +118,54 @@ String systemInfo()
     return info;
 }
 
+// Prometheus text format. The driver's times are in µs, exported in seconds
+void appendMetric(String &out, const char *name, const char *type, const char *help, const String &value)
+{
+    out += String("# HELP ") + name + " " + help + "\n";
+    out += String("# TYPE ") + name + " " + type + "\n";
+    out += String(name) + " " + value + "\n";
+}
+
+void appendHistogram(String &out, const char *name, const char *help, const ScrollingDisplayIntf::Histogram &h)
+{
+    out += String("# HELP ") + name + " " + help + "\n";
+    out += String("# TYPE ") + name + " histogram\n";
+    uint32_t cumulative = 0;
+    for (int i = 0; i <= h.Buckets; i++)
+    {
+        cumulative += h.counts[i];
+        String le = i < h.Buckets ? String(h.bounds[i] * 1e-6, 6) : String("+Inf");
+        out += String(name) + "_bucket{le=\"" + le + "\"} " + cumulative + "\n";
+    }
+    out += String(name) + "_sum " + String(h.sum * 1e-6, 6) + "\n";
+    out += String(name) + "_count " + h.count + "\n";
+}
+
+String metricsText()
+{
+    ScrollingDisplayIntf::Metrics m;
+    ScrollingDisplay.getMetrics(m);
+    ScrollingDisplayIntf::Stats stats = ScrollingDisplay.getStats();
+
+    String out;
+    out.reserve(6 * 1024);
+    appendHistogram(out, "display_wake_latency_seconds", "How late the scan ran after its timer alarm.", m.wakeLatency);
+    appendHistogram(out, "display_slot_overrun_seconds", "How far scan slots that overran went past their time.", m.slotOverrun);
+    appendHistogram(out, "display_frame_period_seconds", "Time between frame starts.", m.framePeriod);
+    appendHistogram(out, "display_scroll_lag_seconds", "Time from rendering a scroll position to showing it.", m.scrollLag);
+    appendHistogram(out, "display_render_seconds", "Time taken to render a frame.", m.renderTime);
+    appendMetric(out, "display_frames_total", "counter", "Frames scanned.", String(m.frames));
+    appendMetric(out, "display_frames_late_total", "counter", "Frames that started more than a frame late.", String(m.framesLate));
+    appendMetric(out, "display_frames_rendered_total", "counter", "Frames rendered.", String(m.framesRendered));
+    appendMetric(out, "display_frames_dropped_total", "counter", "Rendered frames replaced before being shown.", String(m.framesDropped));
+    appendMetric(out, "display_spi_queue_failures_total", "counter", "Rows that couldn't be queued to the SPI driver.", String(m.spiQueueFailures));
+    appendMetric(out, "display_timer_interrupts_total", "counter", "Scan timer interrupts.", String(stats.timerInterrupts));
+    appendMetric(out, "display_spi_transfer_seconds", "gauge", "Time taken to shift out the last row.", String(stats.spiTransferUs * 1e-6, 6));
+    appendMetric(out, "display_spi_transfer_max_seconds", "gauge", "Longest row shift since boot.", String(stats.spiTransferMaxUs * 1e-6, 6));
+    appendMetric(out, "free_heap_bytes", "gauge", "Free heap.", String(ESP.getFreeHeap()));
+    return out;
+}
+
 void initServer()
 {
     // Serve index.html from LittleFS
@@ -137,6 +203,113 @@ void initServer()
         }
         server.send(200, "text/plain", ""); });
 
+    // /setbrightness?level=<0..255>&schedule=<HH:MM=level,...>&tz=<POSIX TZ>; any left out keep their current
+    // value, and a blank schedule clears it
+    server.on("/setbrightness", HTTP_GET, []()
+              {
+        if (server.hasArg("level")) {
+            brightness = constrain(server.arg("level").toInt(), 0, 255);
+        }
+        if (server.hasArg("schedule")) {
+            String temp = server.arg("schedule");   // blank clears it
+            if (temp.length() < 128) {
+                brightnessSchedule = temp;
+            }
+        }
+        String temp = server.arg("tz");
+        if (temp.length() && temp.length() < 64) {
+            timezone = temp;
+            configTzTime(timezone.c_str(), NTP_SERVER);
+        }
+
+        applyBrightness();
+        saveSettings();
+        server.send(200, "text/plain", ""); });
+
+    // GET /brightness: the current settings, {"level":<0..255>,"schedule":"..","tz":".."}
+    server.on("/brightness", HTTP_GET, []()
+              {
+        JsonDocument doc;
+        doc["level"] = brightness;
+        doc["schedule"] = brightnessSchedule;
+        doc["tz"] = timezone;
+        String json;
+        serializeJson(doc, json);
+        server.send(200, "application/json", json); });
+
+    // display timing, for Prometheus
+    server.on("/metrics", HTTP_GET, []()
+              { server.send(200, "text/plain; version=0.0.4", metricsText()); });
+
+#if EVENT_TRACE
+    // the event trace, as Chrome trace JSON (load it in chrome://tracing or ui.perfetto.dev)
+    server.on("/trace", HTTP_GET, []()
+              {
+        server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        server.sendHeader("Content-Disposition", "attachment; filename=trace.json");
+        server.send(200, "application/json", "");
+        traceWriteJson([](const String &chunk)
+                       { server.sendContent(chunk); });
+        server.sendContent(""); });
+#endif
+
+    // GET /playlist: the saved playlist
+    server.on("/playlist", HTTP_GET, []()
+              {
+        File f;
+        if (f = LittleFS.open(PLAYLIST_FILENAME, "r")){
+            server.streamFile(f, "application/json");
+            f.close();
+        } else {
+            server.send(200, "application/json", "{\"items\":[]}");
+        } });
+
+    // POST /playlist, body {"items":[{"text":"..","delay":<ms per pixel>,"dwell":<passes>,"transition":"cut|push|wipe"},..]}
+    // an empty list goes back to the single message
+    server.on("/playlist", HTTP_POST, []()
+              {
+        String json = server.arg("plain");
+        if (!applyPlaylist(json)) {
+            server.send(400, "text/plain", "Invalid playlist");
+            return;
+        }
+
+        File file = LittleFS.open(PLAYLIST_FILENAME, "w");
+        if (!file || file.print(json) != json.length()) {
+            server.send(500, "text/plain", "Failed to save playlist");
+        } else {
+            server.send(200, "text/plain", "");
+        }
+        if (file) {
+            file.close();
+        } });
+
+    // /setgeometry?modules=<n>&moduleColumns=<n>&registerBits=<n>&reverseChain=<0|1>&mirrored=<bitmask>
+    // saved, then applied by rebooting
+    server.on("/setgeometry", HTTP_GET, []()
+              {
+        if (server.hasArg("modules"))
+            geometry.modules = server.arg("modules").toInt();
+        if (server.hasArg("moduleColumns"))
+            geometry.moduleColumns = server.arg("moduleColumns").toInt();
+        if (server.hasArg("registerBits"))
+            geometry.registerBits = server.arg("registerBits").toInt();
+        if (server.hasArg("reverseChain"))
+            geometry.reverseChain = server.arg("reverseChain").toInt() != 0;
+        if (server.hasArg("mirrored"))
+            geometry.mirrored = server.arg("mirrored").toInt();
+
+        saveSettings();
+        server.send(200, "text/plain", "Geometry saved. Rebooting...");
+
+        auto start = millis();
+        while (millis() - start < 500)    // delay for response to be sent to client before rebooting
+        {
+            server.handleClient();
+            delay(1);
+        }
+        ESP.restart(); });
+
     // /setwifi?ssid=<ssid>&pass=<pass>
     server.on("/setwifi", HTTP_GET, []()
               {
@@ -250,21 +423,40 @@ void initServer()
 void setup()
 {
     Serial.begin(115200);
+
+    // init FS, and load saved settings; the panel geometry is needed before the display starts
+    bool fsMounted = LittleFS.begin(true);
+    bool settingsLoaded = fsMounted && loadSettings();
+
+    ScrollingDisplay.setGeometry(geometry);
+#if BENCHMARK
+    // benchmark the render kernels before the display starts, so it doesn't share the CPU
+    String baseline;
+    File baselineFile;
+    if (fsMounted && (baselineFile = LittleFS.open(BENCH_BASELINE_FILENAME, "r")))
+    {
+        baseline = baselineFile.readString();
+        baselineFile.close();
+    }
+    runBenchmarks([](const char *line)
+                  { Serial.println(line); }, baseline.length() ? baseline.c_str() : nullptr);
+#endif
     ScrollingDisplay.begin();
     delay(100);
 
-    // init FS, and load saved settings
-    if (LittleFS.begin(true))
+    if (fsMounted)
     {
-        if (loadSettings())
+        if (settingsLoaded)
         {
             ScrollingDisplay.setText(text);
             ScrollingDisplay.setScrollDelay(scrollDelay);
+            ScrollingDisplay.setBrightness(brightness);
         }
         else
         {
             ScrollingDisplay.setText(systemInfo());
         }
+        loadPlaylist();
     }
 
     pinMode(LED_PIN, OUTPUT);
@@ -279,6 +471,10 @@ void setupWiFi()
     WiFi.mode(WIFI_AP_STA);
     WiFi.softAPConfig(apIP, apIP, IPAddress(255, 255, 255, 0));
     WiFi.softAP(apSsid, apPass);
+#if EVENT_TRACE
+    WiFi.onEvent([](arduino_event_id_t event, arduino_event_info_t info)
+                 { traceEvent(TraceEvent::WiFi, event); });
+#endif
     DEBUG_PRINTF("AP started: %s @ %s\n", apSsid.c_str(), WiFi.softAPIP().toString().c_str());
 }
 
@@ -307,19 +503,80 @@ void handleWiFiConnection()
         }
     }
 
-    // init MDNS after wifi initialised
+    // init MDNS and NTP after wifi initialised
     static bool mdnsInit = false;
     if (!mdnsInit && WiFi.status() == WL_CONNECTED)
     {
         MDNS.begin(mdnsHostName);
+        configTzTime(timezone.c_str(), NTP_SERVER);
         mdnsInit = true;
     }
 }
 
+// Brightness for the current local time from the schedule, or -1 if there's no schedule or the time
+// isn't known yet. The latest entry at or before now applies; before the first entry of the day, the
+// last entry (from the day before) does
+int scheduledBrightness()
+{
+    struct tm now;
+    if (brightnessSchedule.isEmpty() || !getLocalTime(&now, 0))
+    {
+        return -1;
+    }
+
+    int minute = now.tm_hour * 60 + now.tm_min;
+    int level = -1, levelAt = -1;
+    int lastLevel = -1, lastAt = -1;
+
+    int pos = 0;
+    while (pos < (int)brightnessSchedule.length())
+    {
+        int end = brightnessSchedule.indexOf(',', pos);
+        if (end < 0)
+        {
+            end = brightnessSchedule.length();
+        }
+        String entry = brightnessSchedule.substring(pos, end);
+        pos = end + 1;
+
+        int h, m, l;
+        if (sscanf(entry.c_str(), "%d:%d=%d", &h, &m, &l) == 3)
+        {
+            int at = h * 60 + m;
+            l = constrain(l, 0, 255);
+            if (at <= minute && at > levelAt)
+            {
+                level = l;
+                levelAt = at;
+            }
+            if (at > lastAt)
+            {
+                lastLevel = l;
+                lastAt = at;
+            }
+        }
+    }
+
+    return level >= 0 ? level : lastLevel;
+}
+
+void applyBrightness()
+{
+    int level = scheduledBrightness();
+    ScrollingDisplay.setBrightness(level >= 0 ? level : brightness);
+}
+
 void loop()
 {
     handleWiFiConnection();
 
+    static unsigned long lastBrightnessCheck = 0;
+    if (millis() - lastBrightnessCheck > BRIGHTNESS_CHECK_INTERVAL)
+    {
+        applyBrightness();
+        lastBrightnessCheck = millis();
+    }
+
     if (WiFi.isConnected() || WiFi.softAPgetStationNum() > 0)
     {
         static bool serverInited = false;
@@ -329,7 +586,19 @@ void loop()
             serverInited = true;
         }
 
+#if EVENT_TRACE
+        // only trace the calls that served something, or polling would fill the trace
+        uint32_t start = traceTime();
+        server.handleClient();
+        uint32_t end = traceTime();
+        if (end - start >= TRACE_HTTP_MIN_US)
+        {
+            traceEventAt(TraceEvent::HttpBegin, start);
+            traceEventAt(TraceEvent::HttpEnd, end);
+        }
+#else
         server.handleClient();
+#endif
     }
 }
 
@@ -366,6 +635,21 @@ bool loadSettings()
         scrollDelay = doc["delay"].as<int>();
     if (doc.containsKey("hostname"))
         mdnsHostName = doc["hostname"].as<String>();
+    if (doc.containsKey("brightness"))
+        brightness = doc["brightness"].as<int>();
+    if (doc.containsKey("schedule"))
+        brightnessSchedule = doc["schedule"].as<String>();
+    if (doc.containsKey("tz"))
+        timezone = doc["tz"].as<String>();
+    if (doc.containsKey("geometry"))
+    {
+        JsonObject g = doc["geometry"];
+        geometry.modules = g["modules"] | geometry.modules;
+        geometry.moduleColumns = g["moduleColumns"] | geometry.moduleColumns;
+        geometry.registerBits = g["registerBits"] | geometry.registerBits;
+        geometry.reverseChain = g["reverseChain"] | geometry.reverseChain;
+        geometry.mirrored = g["mirrored"] | geometry.mirrored;
+    }
 
     return true;
 }
@@ -380,6 +664,15 @@ bool saveSettings()
     doc["text"] = text;
     doc["delay"] = scrollDelay;
     doc["hostname"] = mdnsHostName;
+    doc["brightness"] = brightness;
+    doc["schedule"] = brightnessSchedule;
+    doc["tz"] = timezone;
+    JsonObject g = doc["geometry"].to<JsonObject>();
+    g["modules"] = geometry.modules;
+    g["moduleColumns"] = geometry.moduleColumns;
+    g["registerBits"] = geometry.registerBits;
+    g["reverseChain"] = geometry.reverseChain;
+    g["mirrored"] = geometry.mirrored;
 
     File file = LittleFS.open(SETTINGS_FILENAME, "w");
     if (!file)
@@ -398,3 +691,60 @@ bool saveSettings()
     file.close();
     return true;
 }
+
+// Parse a playlist and show it; returns false (leaving the display alone) if it isn't valid
+bool applyPlaylist(const String &json)
+{
+    JsonDocument doc;
+    if (deserializeJson(doc, json))
+    {
+        return false;
+    }
+
+    JsonArray list = doc["items"].as<JsonArray>();
+    if (list.isNull())
+    {
+        return false;
+    }
+
+    using Transition = ScrollingDisplayIntf::Transition;
+    static ScrollingDisplayIntf::PlaylistItem items[ScrollingDisplayIntf::MaxPlaylistItems];
+    int count = 0;
+    for (JsonObject entry : list)
+    {
+        if (count == ScrollingDisplayIntf::MaxPlaylistItems)
+        {
+            break;
+        }
+
+        ScrollingDisplayIntf::PlaylistItem &item = items[count++];
+        item.text = entry["text"].as<String>();
+        int delay = entry["delay"] | 0;   // 0 for the display's scroll speed
+        item.milliPixelsPerSecond = delay > 0 ? 1000000 / delay : 0;
+        item.dwell = max(entry["dwell"] | 1, 1);
+        String transition = entry["transition"] | "cut";
+        item.transition = transition == "push" ? Transition::Push : transition == "wipe" ? Transition::Wipe : Transition::Cut;
+    }
+
+    ScrollingDisplay.setPlaylist(items, count);
+    return true;
+}
+
+bool loadPlaylist()
+{
+    File file = LittleFS.open(PLAYLIST_FILENAME, "r");
+    if (!file)
+    {
+        return false;   // no playlist, just the text
+    }
+
+    String json = file.readString();
+    file.close();
+
+    if (!applyPlaylist(json))
+    {
+        DEBUG_PRINTLN("Failed to parse playlist.json");
+        return false;
+    }
+    return true;
+}
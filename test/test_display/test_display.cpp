@@ -0,0 +1,382 @@
+// The display end to end on the simulated ESP32: the text stream and row composition, checked against
+// what the panel showed
+#include <unity.h>
+
+#include "ScrollingDisplay.h"
+#include "Adafruit_GFX.h"
+#include "Font5x7Fixed.h"
+#include "ScanReport.h"
+#include "SimHost.h"
+#include "SimPanel.h"
+
+#define ROWS 7
+
+int getTextWidth(const GFXfont *f, const String &text);    // in ScrollingDisplay.cpp
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// whether the panel shows the message canvas from column 'offset', wrapping round at its end
+static bool showsAt(const GFXcanvas1 &message, int offset)
+{
+    int columns = ScrollingDisplay.getColumns();
+    for (int r = 0; r < ROWS; r++)
+    {
+        for (int c = 0; c < columns; c++)
+        {
+            bool lit = simPanel.shown[r][c / 8] & (0x80 >> (c % 8));
+            if (lit != message.getPixel((offset + c) % message.width(), r))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// the column of the message canvas the panel shows from, or -1 if it doesn't show it
+static int findOffset(const GFXcanvas1 &message)
+{
+    for (int offset = 0; offset < message.width(); offset++)
+    {
+        if (showsAt(message, offset))
+        {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+// Looks for what the panel shows with find(), which returns -1 if it isn't there. Rows are latched one
+// after another, so once a frame's first row is up, it's ahead of the rest until the frame's been
+// scanned; so if it isn't there, look again over the next few ms
+template <typename Find> static int settle(Find find)
+{
+    int found = find();
+    for (int wait = 0; found < 0 && wait < 20; wait++)
+    {
+        simRun(1000);
+        found = find();
+    }
+    return found;
+}
+
+// the columns a message takes on the display, with the gap to the panel's width if it's shorter
+static int messageWidth(const String &text, const GFXfont *font = &Font5x7Fixed)
+{
+    return max(ScrollingDisplay.getColumns(), getTextWidth(font, text));
+}
+
+// one repeat of the message, with the ink of the repeats either side that reaches into it
+static void drawMessage(GFXcanvas1 &canvas, const String &text, const GFXfont *font = &Font5x7Fixed)
+{
+    canvas.fillScreen(0);
+    canvas.setFont(font);
+    canvas.setTextWrap(false);
+    for (int x = -canvas.width(); x <= canvas.width(); x += canvas.width())
+    {
+        canvas.setCursor(x, ROWS);
+        for (unsigned i = 0; i < text.length(); i++)
+        {
+            canvas.write(text[i]);
+        }
+    }
+}
+
+void test_static_text()
+{
+    String text = "Static text";
+    ScrollingDisplay.setScrollSpeed(0);
+    ScrollingDisplay.setText(text);
+    simRun(SCAN_WARMUP_US);
+
+    GFXcanvas1 message(messageWidth(text), ROWS);
+    drawMessage(message, text);
+    TEST_ASSERT_TRUE(showsAt(message, 0));
+}
+
+// a message longer than the panel, no part of which repeats, so there's only one place it matches
+static String longMessage()
+{
+    String text;
+    for (int i = 0; text.length() < 150; i++)
+    {
+        text += String(i) + " ";
+    }
+    return text;
+}
+
+// Checks the panel shows the message moving on by about 100 pixels each half second (at 200 pixels
+// a second), left or right, part way through and after wrapping round
+static void checkScrolling(const String &text, int direction, const GFXfont *font = &Font5x7Fixed)
+{
+    GFXcanvas1 message(messageWidth(text, font), ROWS);
+    drawMessage(message, text, font);
+    int period = message.width();
+
+    int last = 0;
+    for (int step = 0; step < 8; step++)
+    {
+        simRun(500000);
+        int offset = settle([&]() { return findOffset(message); });
+        TEST_ASSERT_TRUE_MESSAGE(offset >= 0, "panel doesn't show the message");
+
+        int moved = (direction * (offset - last) + period) % period;
+        TEST_ASSERT_TRUE(moved >= 90 && moved <= 110);
+        last = offset;
+    }
+}
+
+// a message longer than the panel, part way through and after wrapping round
+void test_scrolling_text()
+{
+    String text = longMessage();
+    ScrollingDisplay.setScrollSpeed(200000);
+    ScrollingDisplay.setText(text);
+    checkScrolling(text, 1);
+}
+
+// a zone over the whole panel, scrolling right
+void test_reverse_zone()
+{
+    ScrollingDisplayIntf::Zone zone;
+    zone.width = ScrollingDisplay.getColumns();
+    zone.text = longMessage();
+    zone.milliPixelsPerSecond = 200000;
+    zone.reverse = true;
+    ScrollingDisplay.setZones(&zone, 1);
+    checkScrolling(zone.text, -1);
+    ScrollingDisplay.setZones(nullptr, 0);
+    simRun(100000);     // for the render task to take it, before the next test's setter would be ignored
+}
+
+// the default font with capitals reaching a column into the glyph before and lower case letters
+// a column into the glyph after, each way
+void test_overhanging_font()
+{
+    static GFXglyph glyphs['~' - ' ' + 1];
+    memcpy(glyphs, Font5x7FixedGlyphs, sizeof(glyphs));
+    for (char c = 'A'; c <= 'Z'; c++)
+    {
+        glyphs[c - ' '].xOffset = -1;
+    }
+    for (char c = 'a'; c <= 'z'; c++)
+    {
+        glyphs[c - ' '].xOffset = 2;
+    }
+    static GFXfont font = Font5x7Fixed;
+    font.glyph = glyphs;
+
+    ScrollingDisplayIntf::Zone zone;
+    zone.width = ScrollingDisplay.getColumns();
+    zone.text = "Overhang " + longMessage() + "AaBbCc ";
+    zone.font = &font;
+    zone.milliPixelsPerSecond = 200000;
+    ScrollingDisplay.setZones(&zone, 1);
+    checkScrolling(zone.text, 1, &font);
+
+    zone.reverse = true;
+    ScrollingDisplay.setZones(&zone, 1);
+    checkScrolling(zone.text, -1, &font);
+    ScrollingDisplay.setZones(nullptr, 0);
+    simRun(100000);     // for the render task to take it, before the next test's setter would be ignored
+}
+
+using Transition = ScrollingDisplayIntf::Transition;
+
+// Playlist items scroll at 1000 pixels a second, so a pixel is a ms, and are all shorter than the
+// panel, so each pass is a panel's width
+#define PLAYLIST_SPEED 1000000
+#define PLAYLIST_TOLERANCE 40   // pixels; a frame's scroll step, and a frame to start the playlist
+
+static uint64_t playlistStart = 0;
+
+static void startPlaylist(const ScrollingDisplayIntf::PlaylistItem *items, int count)
+{
+    ScrollingDisplay.setPlaylist(items, count);
+    playlistStart = simTime();
+}
+
+static void stopPlaylist()
+{
+    ScrollingDisplay.setPlaylist(nullptr, 0);
+    simRun(100000);
+}
+
+// runs the display until the playlist's scrolled about this many pixels since it started
+static void runToPixel(int pixel)
+{
+    simRun(playlistStart + pixel * 1000 - simTime());
+}
+
+static ScrollingDisplayIntf::PlaylistItem playlistItem(const char *text, uint16_t dwell, Transition transition)
+{
+    ScrollingDisplayIntf::PlaylistItem item;
+    item.text = text;
+    item.milliPixelsPerSecond = PLAYLIST_SPEED;
+    item.dwell = dwell;
+    item.transition = transition;
+    return item;
+}
+
+// Checks the panel shows the item's message from about column 'offset' of it
+static void checkItemAt(const char *text, int offset)
+{
+    GFXcanvas1 message(messageWidth(text), ROWS);
+    drawMessage(message, text);
+    int shown = settle([&]() { return findOffset(message); });
+    TEST_ASSERT_TRUE_MESSAGE(shown >= 0, text);
+    TEST_ASSERT_INT_WITHIN(PLAYLIST_TOLERANCE, offset, shown);
+}
+
+// The panel part way through a transition 'step' columns in, from the outgoing item 'from' to 'to'.
+// The outgoing item carries on scrolling; the incoming one starts from its first column
+static void drawTransition(GFXcanvas1 &view, const GFXcanvas1 &from, const GFXcanvas1 &to, Transition transition,
+                           int step)
+{
+    int columns = view.width();
+    for (int r = 0; r < ROWS; r++)
+    {
+        for (int c = 0; c < columns; c++)
+        {
+            bool lit;
+            if (transition == Transition::Push)
+            {
+                // the incoming item comes in behind the outgoing one, from the right
+                lit = c < columns - step ? from.getPixel((step + c) % from.width(), r)
+                                         : to.getPixel(c - (columns - step), r);
+            }
+            else
+            {
+                // the incoming item is uncovered from the left
+                lit = c < step ? to.getPixel(c, r) : from.getPixel((step + c) % from.width(), r);
+            }
+            view.drawPixel(c, r, lit);
+        }
+    }
+}
+
+// the step the transition the panel shows is at, or -1 if it doesn't show it
+static int findTransition(const GFXcanvas1 &from, const GFXcanvas1 &to, Transition transition)
+{
+    GFXcanvas1 view(ScrollingDisplay.getColumns(), ROWS);
+    for (int step = 1; step < view.width(); step++)
+    {
+        drawTransition(view, from, to, transition, step);
+        if (showsAt(view, 0))
+        {
+            return step;
+        }
+    }
+    return -1;
+}
+
+// an item that dwells for two passes is still there half way through the second one
+void test_playlist_dwell()
+{
+    int columns = ScrollingDisplay.getColumns();
+    ScrollingDisplayIntf::PlaylistItem items[] = {
+        playlistItem("Twice round", 2, Transition::Cut),
+        playlistItem("Then this", 1, Transition::Cut),
+    };
+    startPlaylist(items, 2);
+
+    runToPixel(columns / 2);
+    checkItemAt("Twice round", columns / 2);
+    runToPixel(columns + columns / 2);
+    checkItemAt("Twice round", columns / 2);
+    runToPixel(2 * columns + columns / 2);
+    checkItemAt("Then this", columns / 2);
+    stopPlaylist();
+}
+
+// each item in turn, then back to the first
+void test_playlist_next_item()
+{
+    int columns = ScrollingDisplay.getColumns();
+    const char *texts[] = {"First item", "Second item", "Third item"};
+    ScrollingDisplayIntf::PlaylistItem items[3];
+    for (int i = 0; i < 3; i++)
+    {
+        items[i] = playlistItem(texts[i], 1, Transition::Cut);
+    }
+    startPlaylist(items, 3);
+
+    for (int pass = 0; pass < 4; pass++)
+    {
+        runToPixel(pass * columns + columns / 2);
+        checkItemAt(texts[pass % 3], columns / 2);
+    }
+    stopPlaylist();
+}
+
+// Checks the panel half way through the transition from one item to the next, and once the next one's
+// been on for a bit. A cut goes straight to the next item, the others take a panel's width of scrolling;
+// the next item dwells for two passes, so it's still on for the second check
+static void checkTransition(Transition transition)
+{
+    int columns = ScrollingDisplay.getColumns();
+    ScrollingDisplayIntf::PlaylistItem items[] = {
+        playlistItem("Outgoing item", 1, transition),
+        playlistItem("Incoming item", 2, transition),
+    };
+    startPlaylist(items, 2);
+
+    runToPixel(columns + columns / 2);
+    if (transition == Transition::Cut)
+    {
+        checkItemAt("Incoming item", columns / 2);
+    }
+    else
+    {
+        GFXcanvas1 from(messageWidth(items[0].text), ROWS);
+        GFXcanvas1 to(messageWidth(items[1].text), ROWS);
+        drawMessage(from, items[0].text);
+        drawMessage(to, items[1].text);
+        int step = settle([&]() { return findTransition(from, to, transition); });
+        TEST_ASSERT_TRUE_MESSAGE(step >= 0, "panel doesn't show the transition");
+        TEST_ASSERT_INT_WITHIN(PLAYLIST_TOLERANCE, columns / 2, step);
+    }
+
+    runToPixel(2 * columns + columns / 4);
+    checkItemAt("Incoming item", columns / 4);
+    stopPlaylist();
+}
+
+void test_playlist_cut()
+{
+    checkTransition(Transition::Cut);
+}
+
+void test_playlist_push()
+{
+    checkTransition(Transition::Push);
+}
+
+void test_playlist_wipe()
+{
+    checkTransition(Transition::Wipe);
+}
+
+int main(int argc, char **argv)
+{
+    ScrollingDisplay.begin();
+    simRun(SCAN_WARMUP_US);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_static_text);
+    RUN_TEST(test_scrolling_text);
+    RUN_TEST(test_reverse_zone);
+    RUN_TEST(test_overhanging_font);
+    RUN_TEST(test_playlist_dwell);
+    RUN_TEST(test_playlist_next_item);
+    RUN_TEST(test_playlist_cut);
+    RUN_TEST(test_playlist_push);
+    RUN_TEST(test_playlist_wipe);
+    return UNITY_END();
+}
@@ -0,0 +1,147 @@
+// Panel geometries on the simulated ESP32: the order the display's columns are shifted out in, for 6, 7
+// and 8 modules, with spare register bits, a reversed chain and mirrored modules. The geometry is only
+// taken by begin(), which runs once per process, so each one is run in a child process of its own
+#include <unity.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ScrollingDisplay.h"
+#include "Adafruit_GFX.h"
+#include "Font5x7Fixed.h"
+#include "ScanReport.h"
+#include "SimHost.h"
+#include "SimPanel.h"
+
+#define ROWS 7
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// the bit of the shifted-out row that display column c is in: its module's slot in the chain, then
+// the module's LED columns, right to left if it's mirrored
+static int shiftedBit(const ScrollingDisplayIntf::Geometry &g, int c)
+{
+    int m = c / g.moduleColumns;
+    int k = c % g.moduleColumns;
+    int slot = g.reverseChain ? g.modules - 1 - m : m;
+    bool mirrored = (g.mirrored >> m) & 1;
+    return slot * g.registerBits + (mirrored ? g.moduleColumns - 1 - k : k);
+}
+
+// Shows a message wider than the panel, without scrolling, and checks every bit the panel latched
+// against the message column it should be, and that the spare register bits are off. Prints the first
+// mismatch and returns false if there is one
+static bool checkGeometry(const ScrollingDisplayIntf::Geometry &g)
+{
+    ScrollingDisplay.setGeometry(g);
+    ScrollingDisplay.begin();
+    simRun(SCAN_WARMUP_US);
+
+    String text;
+    for (int i = 0; text.length() < 100; i++)
+    {
+        text += String(i) + " ";
+    }
+    ScrollingDisplay.setScrollSpeed(0);
+    ScrollingDisplay.setText(text);
+    simRun(SCAN_WARMUP_US);
+
+    int columns = ScrollingDisplay.getColumns();
+    GFXcanvas1 message(columns, ROWS);
+    message.fillScreen(0);
+    message.setFont(&Font5x7Fixed);
+    message.setTextWrap(false);
+    message.setCursor(0, ROWS);
+    for (unsigned i = 0; i < text.length(); i++)
+    {
+        message.write(text[i]);
+    }
+
+    int bits = g.modules * g.registerBits;
+    bool expected[SimPanel::MaxRowBytes * 8];
+    for (int r = 0; r < ROWS; r++)
+    {
+        memset(expected, 0, sizeof(expected));
+        for (int c = 0; c < columns; c++)
+        {
+            expected[shiftedBit(g, c)] = message.getPixel(c, r);
+        }
+        for (int b = 0; b < bits; b++)
+        {
+            bool lit = simPanel.shown[r][b / 8] & (0x80 >> (b % 8));
+            if (lit != expected[b])
+            {
+                printf("  row %d, bit %d is %s\n", r, b, lit ? "lit" : "off");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// runs checkGeometry() in a child process
+static void testGeometry(int modules, int registerBits, bool reverseChain, uint8_t mirrored)
+{
+    ScrollingDisplayIntf::Geometry g;
+    g.modules = modules;
+    g.moduleColumns = 60;
+    g.registerBits = registerBits;
+    g.reverseChain = reverseChain;
+    g.mirrored = mirrored;
+
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+    {
+        bool ok = checkGeometry(g);
+        fflush(stdout);
+        _exit(ok ? 0 : 1);
+    }
+    int status = -1;
+    waitpid(child, &status, 0);
+
+    char message[80];
+    snprintf(message, sizeof(message), "%d modules, %d bits, %s chain, mirrored 0x%02x", modules, registerBits,
+             reverseChain ? "reversed" : "forward", mirrored);
+    TEST_ASSERT_TRUE_MESSAGE(WIFEXITED(status) && WEXITSTATUS(status) == 0, message);
+}
+
+// each arrangement of a chain of this many modules
+static void testModules(int modules)
+{
+    testGeometry(modules, 60, false, 0);
+    testGeometry(modules, 64, false, 0);
+    testGeometry(modules, 60, true, 0);
+    testGeometry(modules, 60, false, 0x55);
+    testGeometry(modules, 64, true, 0x96);
+}
+
+void test_6_modules()
+{
+    testModules(6);
+}
+
+void test_7_modules()
+{
+    testModules(7);
+}
+
+void test_8_modules()
+{
+    testModules(8);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_6_modules);
+    RUN_TEST(test_7_modules);
+    RUN_TEST(test_8_modules);
+    return UNITY_END();
+}
@@ -0,0 +1,98 @@
+// Text rendering on the host: text widths, the 1 bit canvas, and the golden images (host/golden)
+#include <unity.h>
+
+#include <Arduino.h>
+
+#include "Adafruit_GFX.h"
+#include "Font5x7Fixed.h"
+#include "Font5x7FixedMono.h"
+#include "GoldenImages.h"
+
+#include <string>
+
+int getTextWidth(const GFXfont *f, const String &text);    // in ScrollingDisplay.cpp
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// the golden images, found from this file's path, for whatever directory the tests run in
+static std::string goldenDir()
+{
+    std::string file = __FILE__;
+    return file.substr(0, file.rfind("test/")) + "host/golden";
+}
+
+// getTextWidth() is how far write() moves the cursor
+void test_text_width()
+{
+    const GFXfont *fonts[] = {&Font5x7Fixed, &Font5x7FixedMono};
+    const char *texts[] = {"", "i", "Hello, world", "MMMM iiii", "\x01 not in the font \x7F"};
+    for (const GFXfont *font : fonts)
+    {
+        for (const char *text : texts)
+        {
+            GFXcanvas1 canvas(8, 8);
+            canvas.setFont(font);
+            canvas.setTextWrap(false);
+            canvas.setCursor(0, 7);
+            for (const char *c = text; *c; c++)
+            {
+                canvas.write(*c);
+            }
+            TEST_ASSERT_EQUAL_MESSAGE(canvas.getCursorX(), getTextWidth(font, text), text);
+        }
+    }
+}
+
+void test_canvas_pixels()
+{
+    GFXcanvas1 canvas(20, 3);
+    canvas.fillScreen(0);
+    canvas.drawPixel(9, 1, 1);
+    canvas.drawPixel(20, 1, 1);     // off the canvas
+    canvas.drawPixel(-1, 1, 1);
+    for (int y = 0; y < 3; y++)
+    {
+        for (int x = 0; x < 20; x++)
+        {
+            TEST_ASSERT_EQUAL(x == 9 && y == 1, canvas.getPixel(x, y));
+        }
+    }
+
+    canvas.fillScreen(1);
+    for (int x = 0; x < 20; x++)
+    {
+        TEST_ASSERT_TRUE(canvas.getPixel(x, 2));
+    }
+
+    // a line across byte boundaries, and one clipped at both ends
+    canvas.fillScreen(0);
+    canvas.drawFastHLine(3, 0, 14, 1);
+    canvas.drawFastHLine(-5, 2, 30, 1);
+    for (int x = 0; x < 20; x++)
+    {
+        TEST_ASSERT_EQUAL(x >= 3 && x < 17, canvas.getPixel(x, 0));
+        TEST_ASSERT_FALSE(canvas.getPixel(x, 1));
+        TEST_ASSERT_TRUE(canvas.getPixel(x, 2));
+    }
+}
+
+// the same check as the host program's --golden
+void test_golden_images()
+{
+    TEST_ASSERT_EQUAL(0, checkGoldenImages(goldenDir().c_str(), false));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_text_width);
+    RUN_TEST(test_canvas_pixels);
+    RUN_TEST(test_golden_images);
+    return UNITY_END();
+}
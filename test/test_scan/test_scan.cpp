@@ -0,0 +1,40 @@
+// The scan on the simulated ESP32: refresh rate, row balance and duty, late frames and ghosting,
+// against the limits in ScanReport.h. It's the host program's --scan --check, for the build flags
+// the tests are built with
+#include <unity.h>
+
+#include "ScrollingDisplay.h"
+#include "ScanReport.h"
+#include "SimHost.h"
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_scan_full_brightness()
+{
+    ScrollingDisplay.setBrightness(255);
+    simRun(SCAN_WARMUP_US);
+    TEST_ASSERT_TRUE(scanReport(1, 255, true));
+}
+
+void test_scan_dimmed()
+{
+    ScrollingDisplay.setBrightness(32);
+    simRun(SCAN_WARMUP_US);
+    TEST_ASSERT_TRUE(scanReport(1, 32, true));
+}
+
+int main(int argc, char **argv)
+{
+    ScrollingDisplay.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_scan_full_brightness);
+    RUN_TEST(test_scan_dimmed);
+    return UNITY_END();
+}